@@ -21,6 +21,34 @@
 #include "OpenParEMmaterials.hpp"
 
 
+// keyword schemas shared by all blocks of a type, in the order given by each block's get_keyword
+
+static constexpr keywordSchema frequencySchema[]={
+   {{"frequency","freq","f"},0,1e12,true,false},
+   {{"relative_permittivity","er","epsr"},1,1e6,true,false},
+   {{"relative_permeability","mur"},1,1e6,true,false},
+   {{"loss_tangent","tand","tandel","conductivity","sigma"},0,1e8,false,true},  // upper limit much too high for loss tangent, unavoidable
+   {{"Rz"},0,0.0001,false,true}
+};
+static constexpr keywordDispatch<5> frequencyDispatch(frequencySchema);
+static_assert(frequencyDispatch.is_perfect(),"Frequency keyword aliases need a larger dispatch table.");
+
+static constexpr keywordSchema temperatureSchema[]={
+   {{"temperature","temp","t"},-273.15,1e5,false,false},
+   {{"er_infinity","epsr_infinity"},1,1e6,true,false},
+   {{"delta_er","delta_epsr"},0,1e6,true,false},
+   {{"m1"},0,100,false,true},
+   {{"m2"},0,100,false,true},
+   {{"relative_permeability","mur"},1,1e6,true,false},
+   {{"loss_tangent","tand","tandel","conductivity","sigma"},0,1e8,false,true}   // upper limit much too high for loss tangent, unavoidable
+};
+static constexpr keywordDispatch<7> temperatureDispatch(temperatureSchema);
+static_assert(temperatureDispatch.is_perfect(),"Temperature keyword aliases need a larger dispatch table.");
+
+static constexpr keywordSchema materialSchema[]={
+   {{"name"},0,0,false,false}
+};
+
 ///////////////////////////////////////////////////////////////////////////////////////////
 // Frequency
 ///////////////////////////////////////////////////////////////////////////////////////////
@@ -29,65 +57,48 @@ Frequency::Frequency (int startLine_, int endLine_, bool checkLimits_)
 {
    startLine=startLine_;
    endLine=endLine_;
+   set_schemas(checkLimits_);
+}
+
+// the keywords in the order of frequencySchema
+keywordPair* Frequency::get_keyword (int i)
+{
+   keywordPair *keywords[]={&frequency,&relative_permittivity,&relative_permeability,&loss,&Rz};
+   return keywords[i];
+}
+
+void Frequency::set_schemas (bool checkLimits_)
+{
+   int i=0;
+   while (i < 5) {
+      get_keyword(i)->set_schema(&frequencySchema[i],checkLimits_);
+      i++;
+   }
+}
 
-   // frequency
-
-   frequency.push_alias("frequency");
-   frequency.push_alias("freq");
-   frequency.push_alias("f");
-   frequency.set_loaded(false);
-   frequency.set_positive_required(true);
-   frequency.set_non_negative_required(false);
-   frequency.set_lowerLimit(0);
-   frequency.set_upperLimit(1e12);
-   frequency.set_checkLimits(checkLimits_);
-
-   // relative permittivity
-
-   relative_permittivity.push_alias("relative_permittivity");
-   relative_permittivity.push_alias("er");
-   relative_permittivity.push_alias("epsr");
-   relative_permittivity.set_loaded(false);
-   relative_permittivity.set_positive_required(true);
-   relative_permittivity.set_non_negative_required(false);
-   relative_permittivity.set_lowerLimit(1);
-   relative_permittivity.set_upperLimit(1e6);
-   relative_permittivity.set_checkLimits(checkLimits_);
-
-   // relative permeability
-
-   relative_permeability.push_alias("relative_permeability");
-   relative_permeability.push_alias("mur");
-   relative_permeability.set_loaded(false);
-   relative_permeability.set_positive_required(true);
-   relative_permeability.set_non_negative_required(false);
-   relative_permeability.set_lowerLimit(1);
-   relative_permeability.set_upperLimit(1e6);
-   relative_permeability.set_checkLimits(checkLimits_);
-
-   // loss
-
-   loss.push_alias("loss_tangent");
-   loss.push_alias("tand");
-   loss.push_alias("tandel");
-   loss.push_alias("conductivity");
-   loss.push_alias("sigma");
-   loss.set_loaded(false);
-   loss.set_positive_required(false);
-   loss.set_non_negative_required(true);
-   loss.set_lowerLimit(0);
-   loss.set_upperLimit(1e8);  // much too high for loss tangent, unavoidable
-   loss.set_checkLimits(checkLimits_);
-
-   // Rz
-
-   Rz.push_alias("Rz");
-   Rz.set_loaded(false);
-   Rz.set_positive_required(false);
-   Rz.set_non_negative_required(true);
-   Rz.set_lowerLimit(0);
-   Rz.set_upperLimit(0.0001);
-   Rz.set_checkLimits(checkLimits_);
+void Frequency::save (string *image)
+{
+   image_put(image,&startLine,sizeof(int));
+   image_put(image,&endLine,sizeof(int));
+   frequency.save(image);
+   relative_permittivity.save(image);
+   relative_permeability.save(image);
+   loss.save(image);
+   Rz.save(image);
+}
+
+// return true on fail
+bool Frequency::restore (const char **position, const char *end)
+{
+   set_schemas(false);
+   if (image_get(position,end,&startLine,sizeof(int))) return true;
+   if (image_get(position,end,&endLine,sizeof(int))) return true;
+   if (frequency.restore(position,end)) return true;
+   if (relative_permittivity.restore(position,end)) return true;
+   if (relative_permeability.restore(position,end)) return true;
+   if (loss.restore(position,end)) return true;
+   if (Rz.restore(position,end)) return true;
+   return false;
 }
 
 void Frequency::print (string indent)
@@ -133,32 +144,18 @@ bool Frequency::load (string *indent, inputFile *inputs)
    int lineNumber=inputs->get_next_lineNumber(startLine);
    int stopLineNumber=inputs->get_previous_lineNumber(endLine);
    while (lineNumber <= stopLineNumber) {
-      string token,value,line;
-      line=inputs->get_line(lineNumber);
-      get_token_pair(&line,&token,&value,&lineNumber,indent->c_str());
+      string_view token,value;
+      split_token_pair(inputs->get_line_view(lineNumber),&token,&value,lineNumber,indent->c_str());
 
       int recognized=0;
-      if (relative_permittivity.match_alias(&token)) {
-         recognized++;
-         if (relative_permittivity.loadDouble(&token, &value, lineNumber)) fail=true;
-      }
-
-      if (relative_permeability.match_alias(&token)) {
-         recognized++;
-         if (relative_permeability.loadDouble(&token, &value, lineNumber)) fail=true;
-      }
-
-      if (loss.match_alias(&token)) {
-         recognized++;
-         if (loss.loadDouble(&token, &value, lineNumber)) fail=true;
-      }
+      int slot=frequencyDispatch.find(token);
 
-      if (Rz.match_alias(&token)) {
+      if (slot > 0) {
          recognized++;
-         if (Rz.loadDouble(&token, &value, lineNumber)) fail=true;
+         if (get_keyword(slot)->loadDouble(token, value, lineNumber)) fail=true;
       }
 
-      if (frequency.match_alias(&token)) {
+      if (slot == 0) {
          if (frequency.is_loaded()) {
             prefix(); PetscPrintf(PETSC_COMM_WORLD,"%sERROR1050: Duplicate entry at line %d for previous entry at line %d.\n",
                                                    indent->c_str(),lineNumber,frequency.get_lineNumber());
@@ -170,7 +167,7 @@ bool Frequency::load (string *indent, inputFile *inputs)
                frequency.set_lineNumber(lineNumber);
                frequency.set_loaded(true);
             } else {
-               if (frequency.loadDouble(&token, &value, lineNumber)) fail=true;
+               if (frequency.loadDouble(token, value, lineNumber)) fail=true;
             }
          }
          recognized++;
@@ -233,85 +230,73 @@ Temperature::Temperature (int startLine_, int endLine_, bool checkLimits_)
 {
    startLine=startLine_;
    endLine=endLine_;
+   set_schemas(checkLimits_);
+}
+
+// the keywords in the order of temperatureSchema
+keywordPair* Temperature::get_keyword (int i)
+{
+   keywordPair *keywords[]={&temperature,&er_infinity,&delta_er,&m1,&m2,&relative_permeability,&loss};
+   return keywords[i];
+}
+
+void Temperature::set_schemas (bool checkLimits_)
+{
+   int i=0;
+   while (i < 7) {
+      get_keyword(i)->set_schema(&temperatureSchema[i],checkLimits_);
+      i++;
+   }
+}
+
+// the compiled tables are not saved since compile () rebuilds them
+void Temperature::save (string *image)
+{
+   image_put(image,&startLine,sizeof(int));
+   image_put(image,&endLine,sizeof(int));
+   temperature.save(image);
+   er_infinity.save(image);
+   delta_er.save(image);
+   m1.save(image);
+   m2.save(image);
+   relative_permeability.save(image);
+   loss.save(image);
+
+   size_t count=frequencyList.size();
+   image_put(image,&count,sizeof(size_t));
+   long unsigned int i=0;
+   while (i < frequencyList.size()) {
+      frequencyList[i]->save(image);
+      i++;
+   }
+}
+
+// return true on fail
+bool Temperature::restore (const char **position, const char *end)
+{
+   set_schemas(false);
+   if (image_get(position,end,&startLine,sizeof(int))) return true;
+   if (image_get(position,end,&endLine,sizeof(int))) return true;
+   if (temperature.restore(position,end)) return true;
+   if (er_infinity.restore(position,end)) return true;
+   if (delta_er.restore(position,end)) return true;
+   if (m1.restore(position,end)) return true;
+   if (m2.restore(position,end)) return true;
+   if (relative_permeability.restore(position,end)) return true;
+   if (loss.restore(position,end)) return true;
+
+   size_t count;
+   if (image_get(position,end,&count,sizeof(size_t))) return true;
+   long unsigned int i=0;
+   while (i < count) {
+      Frequency *newFrequency=new Frequency();
+      frequencyList.push_back(newFrequency);
+      if (newFrequency->restore(position,end)) return true;
+      i++;
+   }
 
-   // temperature
-
-   temperature.push_alias("temperature");
-   temperature.push_alias("temp");
-   temperature.push_alias("t");
-   temperature.set_loaded(false);
-   temperature.set_positive_required(false);
-   temperature.set_non_negative_required(false);
-   temperature.set_lowerLimit(-273.15);
-   temperature.set_upperLimit(1e5);
-   temperature.set_checkLimits(checkLimits_);
-
-   // er_infinity
-
-   er_infinity.push_alias("er_infinity");
-   er_infinity.push_alias("epsr_infinity");
-   er_infinity.set_loaded(false);
-   er_infinity.set_positive_required(true);
-   er_infinity.set_non_negative_required(false);
-   er_infinity.set_lowerLimit(1);
-   er_infinity.set_upperLimit(1e6);
-   er_infinity.set_checkLimits(checkLimits_);
-
-   // delta_er
-
-   delta_er.push_alias("delta_er");
-   delta_er.push_alias("delta_epsr");
-   delta_er.set_loaded(false);
-   delta_er.set_positive_required(true);
-   delta_er.set_non_negative_required(false);
-   delta_er.set_lowerLimit(0);
-   delta_er.set_upperLimit(1e6);
-   delta_er.set_checkLimits(checkLimits_);
-
-   // m1
-
-   m1.push_alias("m1");
-   m1.set_loaded(false);
-   m1.set_positive_required(false);
-   m1.set_non_negative_required(true);
-   m1.set_lowerLimit(0);
-   m1.set_upperLimit(100);
-   m1.set_checkLimits(checkLimits_);
-
-   // m2
-
-   m2.push_alias("m2");
-   m2.set_loaded(false);
-   m2.set_positive_required(false);
-   m2.set_non_negative_required(true);
-   m2.set_lowerLimit(0);
-   m2.set_upperLimit(100);
-   m2.set_checkLimits(checkLimits_);
-
-   // relative permeability
-
-   relative_permeability.push_alias("relative_permeability");
-   relative_permeability.push_alias("mur");
-   relative_permeability.set_loaded(false);
-   relative_permeability.set_positive_required(true);
-   relative_permeability.set_non_negative_required(false);
-   relative_permeability.set_lowerLimit(1);
-   relative_permeability.set_upperLimit(1e6);
-   relative_permeability.set_checkLimits(checkLimits_);
-
-   // loss
-
-   loss.push_alias("loss_tangent");
-   loss.push_alias("tand");
-   loss.push_alias("tandel");
-   loss.push_alias("conductivity");
-   loss.push_alias("sigma");
-   loss.set_loaded(false);
-   loss.set_positive_required(false);
-   loss.set_non_negative_required(true);
-   loss.set_lowerLimit(0);
-   loss.set_upperLimit(1e8);  // much too high for loss tangent, unavoidable
-   loss.set_checkLimits(checkLimits_);
+   isCompiled=false;
+   return false;
 }
 
 void Temperature::print (string indent)
@@ -420,54 +405,25 @@ bool Temperature::load(string *indent, inputFile *inputs, bool checkInputs)
    while (lineNumber <= stopLineNumber) {
 
       if (!inFrequencyBlocks(lineNumber)) {
-         string token,value,line; 
-         line=inputs->get_line(lineNumber);
-         get_token_pair(&line,&token,&value,&lineNumber,*indent);
+         string_view token,value;
+         split_token_pair(inputs->get_line_view(lineNumber),&token,&value,lineNumber,indent->c_str());
 
          int recognized=0;
-         if (frequencyList.size() == 0) {
+         int slot=temperatureDispatch.find(token);
 
-            if (er_infinity.match_alias(&token)) {
+         // Debye variables
+         if (slot > 0) {
+            if (frequencyList.size() == 0) {
                recognized++;
-               if (er_infinity.loadDouble(&token, &value, lineNumber)) fail=true;
-            }
-
-            if (delta_er.match_alias(&token)) {
-               recognized++;
-               if (delta_er.loadDouble(&token, &value, lineNumber)) fail=true;
-            }
-
-            if (m1.match_alias(&token)) {
-               recognized++;
-               if (m1.loadDouble(&token, &value, lineNumber)) fail=true;
-            }
-
-            if (m2.match_alias(&token)) {
-               recognized++;
-               if (m2.loadDouble(&token, &value, lineNumber)) fail=true;
-            }
-
-            if (relative_permeability.match_alias(&token)) {
-               recognized++;
-               if (relative_permeability.loadDouble(&token, &value, lineNumber)) fail=true;
-            }
-
-            if (loss.match_alias(&token)) {
-               recognized++;
-               if (loss.loadDouble(&token, &value, lineNumber)) fail=true;
-            }
-
-         } else {
-            if (er_infinity.match_alias(&token) || delta_er.match_alias(&token) ||
-                m1.match_alias(&token) || m2.match_alias(&token) ||
-                relative_permeability.match_alias(&token) || loss.match_alias(&token)) {
-                prefix(); PetscPrintf(PETSC_COMM_WORLD,"%sERROR1058: Debye variable at line %d is not allowed with frequency blocks defined.\n",
-                                                       indent->c_str(),lineNumber);
-                fail=true;
+               if (get_keyword(slot)->loadDouble(token, value, lineNumber)) fail=true;
+            } else {
+               prefix(); PetscPrintf(PETSC_COMM_WORLD,"%sERROR1058: Debye variable at line %d is not allowed with frequency blocks defined.\n",
+                                                      indent->c_str(),lineNumber);
+               fail=true;
             }
          }
 
-         if (temperature.match_alias(&token)) {
+         if (slot == 0) {
             if (temperature.is_loaded()) {
                prefix(); PetscPrintf(PETSC_COMM_WORLD,"%sERROR1059: Duplicate entry at line %d for previous entry at line %d.\n",
                                                       indent->c_str(),lineNumber,temperature.get_lineNumber());
@@ -479,7 +435,7 @@ bool Temperature::load(string *indent, inputFile *inputs, bool checkInputs)
                   temperature.set_lineNumber(lineNumber);
                   temperature.set_loaded(true);
                } else {
-                  if (temperature.loadDouble(&token, &value, lineNumber)) fail=true;
+                  if (temperature.loadDouble(token, value, lineNumber)) fail=true;
                }
             }
             recognized++;
@@ -597,7 +553,8 @@ bool Temperature::check(string indent)
    return fail;
 }
 
-complex<double> Temperature::get_eps(double frequency_, double tolerance, string indent)
+// reference evaluation directly from the keyword pairs, used before compile () and by test_evaluators
+complex<double> Temperature::get_eps_linear(double frequency_, double tolerance, string indent)
 {
    double eps;
    double loss_;
@@ -613,6 +570,7 @@ complex<double> Temperature::get_eps(double frequency_, double tolerance, string
    double freq_test;          //
    bool found_low=false;      //
    bool found_high=false;     //
+   long unsigned int i_low=0; // block supplying the loss keyword for interpolation
 
    if (frequencyList.size() > 0) {
 
@@ -622,7 +580,7 @@ complex<double> Temperature::get_eps(double frequency_, double tolerance, string
       while (i < frequencyList.size()) {
 
          // any
-         if (frequencyList[i]->get_frequency()->get_value().compare("any") == 0) {
+         if (frequencyList[i]->get_frequency()->is_any()) {
             eps=frequencyList[i]->get_relative_permittivity()->get_dbl_value();
             loss_=frequencyList[i]->get_loss()->get_dbl_value();
             found=true;
@@ -642,6 +600,7 @@ complex<double> Temperature::get_eps(double frequency_, double tolerance, string
 
          if (freq_test < frequency_ && freq_test > freq_low) {
             freq_low=freq_test;
+            i_low=i;
             eps_low=frequencyList[i]->get_relative_permittivity()->get_dbl_value();
             loss_low=frequencyList[i]->get_loss()->get_dbl_value();
             found_low=true;
@@ -660,6 +619,7 @@ complex<double> Temperature::get_eps(double frequency_, double tolerance, string
       // linear interpolation
       if (! found && found_low && found_high) {
          found=true;
+         i=i_low;
          eps=eps_low+(frequency_-freq_low)/(freq_high-freq_low)*(eps_high-eps_low);
          loss_=loss_low+(frequency_-freq_low)/(freq_high-freq_low)*(loss_high-loss_low);
       }
@@ -705,7 +665,7 @@ complex<double> Temperature::get_eps(double frequency_, double tolerance, string
    return complex_eps;
 }
 
-double Temperature::get_mu(double frequency_, double tolerance, string indent)
+double Temperature::get_mu_linear(double frequency_, double tolerance, string indent)
 {
    double mu=-DBL_MAX;
 
@@ -725,7 +685,7 @@ double Temperature::get_mu(double frequency_, double tolerance, string indent)
       while (i < frequencyList.size()) {
 
          // any
-         if (frequencyList[i]->get_frequency()->get_value().compare("any") == 0) {
+         if (frequencyList[i]->get_frequency()->is_any()) {
             mu=frequencyList[i]->get_relative_permeability()->get_dbl_value();
             found=true;
             break;
@@ -774,7 +734,7 @@ double Temperature::get_mu(double frequency_, double tolerance, string indent)
    return mu;
 }
 
-double Temperature::get_Rs(double frequency_, double tolerance, string indent)
+double Temperature::get_Rs_linear(double frequency_, double tolerance, string indent)
 {
    double Rs=-DBL_MAX;
    double loss_;
@@ -793,6 +753,7 @@ double Temperature::get_Rs(double frequency_, double tolerance, string indent)
    double freq_test;          //
    bool found_low=false;      //
    bool found_high=false;     //
+   long unsigned int i_low=0; // block supplying the loss keyword for interpolation
 
    if (frequencyList.size() > 0) {
 
@@ -802,7 +763,7 @@ double Temperature::get_Rs(double frequency_, double tolerance, string indent)
       while (i < frequencyList.size()) {
 
          // any
-         if (frequencyList[i]->get_frequency()->get_value().compare("any") == 0) {
+         if (frequencyList[i]->get_frequency()->is_any()) {
             loss_=frequencyList[i]->get_loss()->get_dbl_value();
             mur_=frequencyList[i]->get_relative_permeability()->get_dbl_value();
             Rz_=frequencyList[i]->get_Rz()->get_dbl_value();
@@ -824,6 +785,7 @@ double Temperature::get_Rs(double frequency_, double tolerance, string indent)
 
          if (freq_test < frequency_ && freq_test > freq_low) {
             freq_low=freq_test;
+            i_low=i;
             loss_low=frequencyList[i]->get_loss()->get_dbl_value();
             mur_low=frequencyList[i]->get_relative_permeability()->get_dbl_value();
             Rz_low=frequencyList[i]->get_Rz()->get_dbl_value();
@@ -844,6 +806,7 @@ double Temperature::get_Rs(double frequency_, double tolerance, string indent)
       // linear interpolation
       if (! found && found_low && found_high) {
          found=true;
+         i=i_low;
          loss_=loss_low+(frequency_-freq_low)/(freq_high-freq_low)*(loss_high-loss_low);
          mur_=mur_low+(frequency_-freq_low)/(freq_high-freq_low)*(mur_high-mur_low);
          Rz_=Rz_low+(frequency_-freq_low)/(freq_high-freq_low)*(Rz_high-Rz_low);
@@ -883,6 +846,355 @@ double Temperature::get_Rs(double frequency_, double tolerance, string indent)
    return Rs;
 }
 
+// Flatten the frequency blocks into tables sorted by frequency and resolve the loss keywords and
+// Debye constants.  Call after a successful check.
+void Temperature::compile ()
+{
+   double eps0=8.8541878176e-12;
+
+   frequencyTable.clear();
+   epsTable.clear();
+   murTable.clear();
+   lossTable.clear();
+   RzTable.clear();
+   lossModelTable.clear();
+   isAnyFrequency=false;
+
+   vector<Frequency *> sortedList;
+   long unsigned int i=0;
+   while (i < frequencyList.size()) {
+      if (frequencyList[i]->get_frequency()->is_any()) {
+         sortedList.clear();
+         sortedList.push_back(frequencyList[i]);
+         isAnyFrequency=true;
+         break;
+      }
+      sortedList.push_back(frequencyList[i]);
+      i++;
+   }
+   if (!isAnyFrequency) {
+      std::stable_sort(sortedList.begin(),sortedList.end(),[](Frequency *a, Frequency *b)
+                       {return a->get_frequency()->get_dbl_value() < b->get_frequency()->get_dbl_value();});
+   }
+
+   i=0;
+   while (i < sortedList.size()) {
+      if (isAnyFrequency) frequencyTable.push_back(0);
+      else frequencyTable.push_back(sortedList[i]->get_frequency()->get_dbl_value());
+      epsTable.push_back(sortedList[i]->get_relative_permittivity()->get_dbl_value());
+      murTable.push_back(sortedList[i]->get_relative_permeability()->get_dbl_value());
+      lossTable.push_back(sortedList[i]->get_loss()->get_dbl_value());
+      RzTable.push_back(sortedList[i]->get_Rz()->get_dbl_value());
+
+      string keyword=sortedList[i]->get_loss()->get_keyword();
+      if (keyword.compare("loss_tangent") == 0 || keyword.compare("tand") == 0 || keyword.compare("tandel") == 0) {
+         lossModelTable.push_back(LOSS_TANGENT);
+      } else {
+         lossModelTable.push_back(LOSS_CONDUCTIVITY);
+      }
+      i++;
+   }
+
+   // Debye
+   if (frequencyList.size() == 0) {
+      string keyword=loss.get_keyword();
+      if (keyword.compare("loss_tangent") == 0 || keyword.compare("tand") == 0 || keyword.compare("tandel") == 0) lossModel=LOSS_TANGENT;
+      else lossModel=LOSS_CONDUCTIVITY;
+
+      debyeEps=relative_permeability.get_dbl_value();
+      debyeLoss=loss.get_dbl_value();
+      debyeM1=pow(10,m1.get_dbl_value());
+      debyeM2=pow(10,m2.get_dbl_value());
+      debyeInfinity=er_infinity.get_dbl_value()*eps0;
+      debyeDelta=delta_er.get_dbl_value()*eps0/(m2.get_dbl_value()-m1.get_dbl_value());
+      debyeMu=4e-7*M_PI*relative_permeability.get_dbl_value();
+   }
+
+   isCompiled=true;
+}
+
+// Locate the frequency in the compiled tables.
+// Returns 0 for a match at index, 1 for interpolation from index to index+1, and -1 if not found.
+// Extrapolation is not supported.
+int Temperature::lookup (double frequency_, double tolerance, long unsigned int *index)
+{
+   if (isAnyFrequency) {*index=0; return 0;}
+
+   long unsigned int k=std::lower_bound(frequencyTable.begin(),frequencyTable.end(),frequency_)-frequencyTable.begin();
+
+   // exact match
+   if (k > 0 && double_compare(frequency_,frequencyTable[k-1],tolerance)) {*index=k-1; return 0;}
+   if (k < frequencyTable.size() && double_compare(frequency_,frequencyTable[k],tolerance)) {*index=k; return 0;}
+
+   // linear interpolation
+   if (k > 0 && k < frequencyTable.size() && frequencyTable[k-1] > 0) {*index=k-1; return 1;}
+
+   return -1;
+}
+
+complex<double> Temperature::get_eps(double frequency_, double tolerance, string indent)
+{
+   if (!isCompiled) return get_eps_linear(frequency_,tolerance,indent);
+
+   double eps0=8.8541878176e-12;
+   complex<double> complex_eps=complex<double>(-DBL_MAX,0);
+
+   if (frequencyTable.size() > 0) {
+      long unsigned int i;
+      int found=lookup(frequency_,tolerance,&i);
+      if (found < 0) return complex_eps;
+
+      double eps=epsTable[i];
+      double loss_=lossTable[i];
+      if (found == 1) {
+         double freq_low=frequencyTable[i];
+         double freq_high=frequencyTable[i+1];
+         eps=epsTable[i]+(frequency_-freq_low)/(freq_high-freq_low)*(epsTable[i+1]-epsTable[i]);
+         loss_=lossTable[i]+(frequency_-freq_low)/(freq_high-freq_low)*(lossTable[i+1]-lossTable[i]);
+      }
+
+      if (lossModelTable[i] == LOSS_TANGENT) complex_eps=complex<double>(eps*eps0,-loss_*eps*eps0);
+      else complex_eps=complex<double>(eps*eps0,-loss_/(2*M_PI*frequency_));
+
+   } else {
+
+      // Debye model
+      double sigma;
+      if (lossModel == LOSS_TANGENT) sigma=2*M_PI*frequency_*debyeEps*eps0*debyeLoss;
+      else sigma=debyeLoss;
+
+      complex<double> t1=complex<double>(debyeM1,2*M_PI*frequency_);
+      complex<double> t2=complex<double>(debyeM2,2*M_PI*frequency_);
+      complex<double> denom=complex<double>(log(10),0);
+      complex<double> conductivity_term=complex<double>(0,-sigma/(2*M_PI*frequency_));
+      complex<double> infinity_term=complex<double>(debyeInfinity,0);
+      complex<double> delta_term=complex<double>(debyeDelta,0);
+
+      complex_eps=infinity_term+delta_term*log(t2/t1)/denom+conductivity_term;
+   }
+
+   return complex_eps;
+}
+
+double Temperature::get_mu(double frequency_, double tolerance, string indent)
+{
+   if (!isCompiled) return get_mu_linear(frequency_,tolerance,indent);
+
+   if (frequencyTable.size() == 0) return debyeMu;
+
+   long unsigned int i;
+   int found=lookup(frequency_,tolerance,&i);
+   if (found < 0) return -DBL_MAX;
+
+   double mu=murTable[i];
+   if (found == 1) {
+      double freq_low=frequencyTable[i];
+      double freq_high=frequencyTable[i+1];
+      mu=murTable[i]+(frequency_-freq_low)/(freq_high-freq_low)*(murTable[i+1]-murTable[i]);
+   }
+
+   return 4e-7*M_PI*mu;
+}
+
+double Temperature::get_Rs(double frequency_, double tolerance, string indent)
+{
+   if (!isCompiled) return get_Rs_linear(frequency_,tolerance,indent);
+
+   double Rs=-DBL_MAX;
+
+   if (frequencyTable.size() == 0) {
+      prefix(); PetscPrintf(PETSC_COMM_WORLD,"%s%s%sERROR1149: Attempt to use a Debye model for an Rs calculation.\n",indent.c_str(),indent.c_str(),indent.c_str());
+      return Rs;
+   }
+
+   long unsigned int i;
+   int found=lookup(frequency_,tolerance,&i);
+   if (found < 0) return Rs;
+
+   if (lossModelTable[i] == LOSS_TANGENT) {
+      prefix(); PetscPrintf(PETSC_COMM_WORLD,"%s%s%sERROR1150: Attempt to use a dielectric model for an Rs calculation.\n",indent.c_str(),indent.c_str(),indent.c_str());
+      return Rs;
+   }
+
+   double loss_=lossTable[i];
+   double mur_=murTable[i];
+   double Rz_=RzTable[i];
+   if (found == 1) {
+      double freq_low=frequencyTable[i];
+      double freq_high=frequencyTable[i+1];
+      loss_=lossTable[i]+(frequency_-freq_low)/(freq_high-freq_low)*(lossTable[i+1]-lossTable[i]);
+      mur_=murTable[i]+(frequency_-freq_low)/(freq_high-freq_low)*(murTable[i+1]-murTable[i]);
+      Rz_=RzTable[i]+(frequency_-freq_low)/(freq_high-freq_low)*(RzTable[i+1]-RzTable[i]);
+   }
+
+   Rs=sqrt(M_PI*frequency_*4e-7*M_PI*mur_/loss_);
+
+   // surface roughness correction as in get_Rs_linear
+   double r=Rz_/(2*sqrt(3)*2*(1+sqrt(2)));
+   double Aflat=36*r*r;
+   double delta=sqrt(1/(M_PI*frequency_*4e-7*M_PI*mur_*loss_));
+   double factor;
+   if (Rz_ == 0) factor=1;
+   else factor=1+84*(M_PI*r*r/Aflat)/(1+delta/r+delta*delta/(2*r*r));
+
+   Rs*=factor;
+
+   return Rs;
+}
+
+// Batch evaluation of eps, mu, and Rs at the given frequencies, in any order.
+// The table lookups are done first so that the arithmetic runs in branch-free loops over contiguous arrays.
+// Entries without data are set to -DBL_MAX as for get_eps, get_mu, and get_Rs, and Rs is -DBL_MAX for
+// dielectrics and Debye models.  Nothing is printed, so this may run on a thread.  Requires compile ().
+void Temperature::evaluate (vector<double> *frequencies, double tolerance, vector<complex<double>> *eps, vector<double> *mu, vector<double> *Rs)
+{
+   double eps0=8.8541878176e-12;
+   long unsigned int n=frequencies->size();
+   const double *f=frequencies->data();
+
+   eps->resize(n);
+   mu->resize(n);
+   Rs->resize(n);
+
+   if (frequencyTable.size() == 0) {
+
+      // Debye model, with log(t2/t1) expanded into its magnitude and angle since t1 and t2 are in the first quadrant
+      double sigmaScale=0;
+      double sigmaConstant=debyeLoss;
+      if (lossModel == LOSS_TANGENT) {sigmaScale=debyeEps*eps0*debyeLoss; sigmaConstant=0;}
+      double scale=debyeDelta/log(10);
+
+      vector<double> real(n),imag(n);
+      long unsigned int k=0;
+      while (k < n) {
+         double w=2*M_PI*f[k];
+         double sigma=sigmaScale*w+sigmaConstant;
+         real[k]=debyeInfinity+scale*(log(hypot(debyeM2,w))-log(hypot(debyeM1,w)));
+         imag[k]=scale*(atan2(w,debyeM2)-atan2(w,debyeM1))-sigma/w;
+         k++;
+      }
+
+      k=0;
+      while (k < n) {
+         (*eps)[k]=complex<double>(real[k],imag[k]);
+         (*mu)[k]=debyeMu;
+         (*Rs)[k]=-DBL_MAX;
+         k++;
+      }
+      return;
+   }
+
+   // table lookups, with an exact match taken as interpolation weight 0 onto itself
+   vector<long unsigned int> lowList(n),highList(n);
+   vector<double> weightList(n);
+   vector<char> validList(n);
+   long unsigned int k=0;
+   while (k < n) {
+      long unsigned int i=0;
+      int found=lookup(f[k],tolerance,&i);
+      lowList[k]=i;
+      highList[k]=i;
+      weightList[k]=0;
+      validList[k]=(found >= 0);
+      if (found == 1) {
+         highList[k]=i+1;
+         weightList[k]=(f[k]-frequencyTable[i])/(frequencyTable[i+1]-frequencyTable[i]);
+      }
+      k++;
+   }
+
+   // interpolation
+   vector<double> epsList(n),murList(n),lossList(n),RzList(n);
+   vector<char> tangentList(n);
+   k=0;
+   while (k < n) {
+      long unsigned int low=lowList[k];
+      long unsigned int high=highList[k];
+      double t=weightList[k];
+      epsList[k]=epsTable[low]+t*(epsTable[high]-epsTable[low]);
+      murList[k]=murTable[low]+t*(murTable[high]-murTable[low]);
+      lossList[k]=lossTable[low]+t*(lossTable[high]-lossTable[low]);
+      RzList[k]=RzTable[low]+t*(RzTable[high]-RzTable[low]);
+      tangentList[k]=(lossModelTable[low] == LOSS_TANGENT);
+      k++;
+   }
+
+   // eps and mu
+   k=0;
+   while (k < n) {
+      double tangentLoss=-lossList[k]*epsList[k]*eps0;
+      double conductorLoss=-lossList[k]/(2*M_PI*f[k]);
+      double real=validList[k] ? epsList[k]*eps0 : -DBL_MAX;
+      double imag=validList[k] ? (tangentList[k] ? tangentLoss : conductorLoss) : 0;
+      (*eps)[k]=complex<double>(real,imag);
+      (*mu)[k]=validList[k] ? 4e-7*M_PI*murList[k] : -DBL_MAX;
+      k++;
+   }
+
+   // Rs with the surface roughness correction from get_Rs_linear
+   k=0;
+   while (k < n) {
+      double mur_=murList[k];
+      double loss_=lossList[k];
+      double Rz_=RzList[k];
+      double value=sqrt(M_PI*f[k]*4e-7*M_PI*mur_/loss_);
+      double r=Rz_/(2*sqrt(3)*2*(1+sqrt(2)));
+      double Aflat=36*r*r;
+      double delta=sqrt(1/(M_PI*f[k]*4e-7*M_PI*mur_*loss_));
+      double factor=(Rz_ == 0) ? 1 : 1+84*(M_PI*r*r/Aflat)/(1+delta/r+delta*delta/(2*r*r));
+      (*Rs)[k]=(validList[k] && !tangentList[k]) ? value*factor : -DBL_MAX;
+      k++;
+   }
+}
+
+// compare the compiled and linear evaluations at the given frequencies
+// returns the number of mismatches and adds the evaluation times in s
+long unsigned int Temperature::test_evaluators (vector<double> *frequencies, double tolerance, double *linearTime, double *compiledTime)
+{
+   if (!isCompiled) compile();
+
+   long unsigned int mismatches=0;
+   bool conductor=(frequencyTable.size() > 0 && lossModelTable[0] == LOSS_CONDUCTIVITY);
+
+   // add the tabulated frequencies and the midpoints between them
+   vector<double> frequencyList=*frequencies;
+   long unsigned int i=0;
+   while (!isAnyFrequency && i < frequencyTable.size()) {
+      frequencyList.push_back(frequencyTable[i]);
+      if (i+1 < frequencyTable.size()) frequencyList.push_back(0.5*(frequencyTable[i]+frequencyTable[i+1]));
+      i++;
+   }
+   frequencies=&frequencyList;
+
+   vector<complex<double>> epsList(frequencies->size());
+   vector<double> muList(frequencies->size());
+   vector<double> RsList(frequencies->size());
+
+   chrono::steady_clock::time_point start=chrono::steady_clock::now();
+   i=0;
+   while (i < frequencies->size()) {
+      epsList[i]=get_eps_linear((*frequencies)[i],tolerance,"");
+      muList[i]=get_mu_linear((*frequencies)[i],tolerance,"");
+      if (conductor) RsList[i]=get_Rs_linear((*frequencies)[i],tolerance,"");
+      i++;
+   }
+   chrono::steady_clock::time_point middle=chrono::steady_clock::now();
+
+   i=0;
+   while (i < frequencies->size()) {
+      if (get_eps((*frequencies)[i],tolerance,"") != epsList[i]) mismatches++;
+      if (get_mu((*frequencies)[i],tolerance,"") != muList[i]) mismatches++;
+      if (conductor && get_Rs((*frequencies)[i],tolerance,"") != RsList[i]) mismatches++;
+      i++;
+   }
+   chrono::steady_clock::time_point stop=chrono::steady_clock::now();
+
+   *linearTime+=chrono::duration<double>(middle-start).count();
+   *compiledTime+=chrono::duration<double>(stop-middle).count();
+
+   return mismatches;
+}
+
 Temperature::~Temperature()
 {
    long unsigned int i=0;
@@ -902,6 +1214,43 @@ Source::Source (int startLine_, int endLine_)
    endLine=endLine_;
 }
 
+void Source::save (string *image)
+{
+   image_put(image,&startLine,sizeof(int));
+   image_put(image,&endLine,sizeof(int));
+
+   size_t count=lineList.size();
+   image_put(image,&count,sizeof(size_t));
+   long unsigned int i=0;
+   while (i < lineList.size()) {
+      image_put(image,&(lineNumberList[i]),sizeof(int));
+      image_put_string(image,lineList[i]);
+      i++;
+   }
+}
+
+// return true on fail
+bool Source::restore (const char **position, const char *end)
+{
+   if (image_get(position,end,&startLine,sizeof(int))) return true;
+   if (image_get(position,end,&endLine,sizeof(int))) return true;
+
+   size_t count;
+   if (image_get(position,end,&count,sizeof(size_t))) return true;
+   long unsigned int i=0;
+   while (i < count) {
+      int lineNumber;
+      string line;
+      if (image_get(position,end,&lineNumber,sizeof(int))) return true;
+      if (image_get_string(position,end,&line)) return true;
+      lineNumberList.push_back(lineNumber);
+      lineList.push_back(line);
+      i++;
+   }
+
+   return false;
+}
+
 void Source::print(string indent)
 {
    prefix(); PetscPrintf(PETSC_COMM_WORLD,"%d: %sSource\n",startLine,indent.c_str());
@@ -917,13 +1266,11 @@ void Source::print(string indent)
 
 bool Source::load(inputFile *inputs)
 {
-   int start_lineNumber=inputs->get_next_lineNumber(startLine);
-   int stop_lineNumber=inputs->get_previous_lineNumber(endLine);
-
-   while (start_lineNumber <= stop_lineNumber) {
-      lineNumberList.push_back(start_lineNumber);
-      lineList.push_back(inputs->get_line(start_lineNumber));
-      start_lineNumber=inputs->get_next_lineNumber(start_lineNumber);
+   long unsigned int i=inputs->block_begin(startLine);
+   while (i < inputs->block_end(endLine)) {
+      lineNumberList.push_back(inputs->get_lineNumber(i));
+      lineList.push_back(string(inputs->get_text(i)));
+      i++;
    }
    return false;
 }
@@ -944,13 +1291,62 @@ Material::Material (int startLine_, int endLine_)
    startLine=startLine_;
    endLine=endLine_;
 
-   name.push_alias("name");
-   name.set_loaded(false);
-   name.set_positive_required(false);
-   name.set_non_negative_required(false);
-   name.set_lowerLimit(0);
-   name.set_upperLimit(0);
-   name.set_checkLimits(false);
+   name.set_schema(&materialSchema[0],false);
+}
+
+void Material::save (string *image)
+{
+   image_put(image,&startLine,sizeof(int));
+   image_put(image,&endLine,sizeof(int));
+   name.save(image);
+   image_put(image,&merged,sizeof(bool));
+
+   size_t count=temperatureList.size();
+   image_put(image,&count,sizeof(size_t));
+   long unsigned int i=0;
+   while (i < temperatureList.size()) {
+      temperatureList[i]->save(image);
+      i++;
+   }
+
+   count=sourceList.size();
+   image_put(image,&count,sizeof(size_t));
+   i=0;
+   while (i < sourceList.size()) {
+      sourceList[i]->save(image);
+      i++;
+   }
+}
+
+// return true on fail
+bool Material::restore (const char **position, const char *end)
+{
+   name.set_schema(&materialSchema[0],false);
+   if (image_get(position,end,&startLine,sizeof(int))) return true;
+   if (image_get(position,end,&endLine,sizeof(int))) return true;
+   if (name.restore(position,end)) return true;
+   if (image_get(position,end,&merged,sizeof(bool))) return true;
+
+   size_t count;
+   if (image_get(position,end,&count,sizeof(size_t))) return true;
+   long unsigned int i=0;
+   while (i < count) {
+      Temperature *newTemperature=new Temperature();
+      temperatureList.push_back(newTemperature);
+      if (newTemperature->restore(position,end)) return true;
+      i++;
+   }
+
+   if (image_get(position,end,&count,sizeof(size_t))) return true;
+   i=0;
+   while (i < count) {
+      Source *newSource=new Source(0,0);
+      sourceList.push_back(newSource);
+      if (newSource->restore(position,end)) return true;
+      i++;
+   }
+
+   return false;
 }
 
 void Material::print(string indent)
@@ -1071,12 +1467,11 @@ bool Material::load(string *indent, inputFile *inputs, bool checkInputs)
    while (lineNumber <= stopLineNumber) {
 
       if (!inTemperatureBlocks(lineNumber) && !inSourceBlocks(lineNumber)) {
-         string token,value,line;
-         line=inputs->get_line(lineNumber);
-         get_token_pair(&line,&token,&value,&lineNumber,*indent);
+         string_view token,value;
+         split_token_pair(inputs->get_line_view(lineNumber),&token,&value,lineNumber,indent->c_str());
 
          int recognized=0;
-         if (name.match_alias(&token)) {
+         if (name.match_alias(token)) {
             if (name.is_loaded()) {
                prefix(); PetscPrintf(PETSC_COMM_WORLD,"%sERROR1074: Duplicate entry at line %d for previous entry at line %d.\n",
                                                       indent->c_str(),lineNumber,name.get_lineNumber());
@@ -1177,7 +1572,7 @@ Temperature* Material::get_temperature(double temperature_, double tolerance, st
    while (i < temperatureList.size()) {
 
       // any
-      if (temperatureList[i]->get_temperature()->get_value().compare("any") == 0) {
+      if (temperatureList[i]->get_temperature()->is_any()) {
          return temperatureList[i];
       }
 
@@ -1228,6 +1623,26 @@ double Material::get_Rs(double temperature_, double frequency, double tolerance,
    return Rs;
 }
 
+void Material::compile ()
+{
+   long unsigned int i=0;
+   while (i < temperatureList.size()) {
+      temperatureList[i]->compile();
+      i++;
+   }
+}
+
+long unsigned int Material::test_evaluators (vector<double> *frequencies, double tolerance, double *linearTime, double *compiledTime)
+{
+   long unsigned int mismatches=0;
+   long unsigned int i=0;
+   while (i < temperatureList.size()) {
+      mismatches+=temperatureList[i]->test_evaluators(frequencies,tolerance,linearTime,compiledTime);
+      i++;
+   }
+   return mismatches;
+}
+
 Material::~Material ()
 {
    long unsigned int i=0;
@@ -1272,8 +1687,9 @@ bool MaterialDatabase::findMaterialBlocks()
    return fail;
 }
 
+// read the file and check the version
 // return true on fail
-bool MaterialDatabase::load(const char *path, const char *filename, bool checkInputs)
+bool MaterialDatabase::read(const char *path, const char *filename)
 {
    // assemble the full path name
    char *fullPathName=(char *)malloc((strlen(path)+strlen(filename)+1)*sizeof(char));
@@ -1281,7 +1697,6 @@ bool MaterialDatabase::load(const char *path, const char *filename, bool checkIn
    sprintf (fullPathName,"%s%s",path,filename);
    prefix(); PetscPrintf(PETSC_COMM_WORLD,"%sloading materials file \"%s\"\n",indent.c_str(),fullPathName);
  
-   bool fail=false;
    if (inputs.load(fullPathName)) {if (fullPathName) free(fullPathName); fullPathName=nullptr; return true;}
    if (fullPathName) {free(fullPathName); fullPathName=nullptr;}
    inputs.createCrossReference();
@@ -1292,7 +1707,14 @@ bool MaterialDatabase::load(const char *path, const char *filename, bool checkIn
       return true;
    }
 
-   // load the materials file
+   return false;
+}
+
+// parse and check all of the materials in the file
+// return true on fail
+bool MaterialDatabase::parse(bool checkInputs)
+{
+   bool fail=false;
 
    if (findMaterialBlocks()) fail=true;
 
@@ -1309,17 +1731,504 @@ bool MaterialDatabase::load(const char *path, const char *filename, bool checkIn
       return fail;
    }
 
+   i=0;
+   while (i < materialList.size()) {
+      materialList[i]->compile();
+      i++;
+   }
+
    return fail;
+}
+
+// return true on fail
+bool MaterialDatabase::load(const char *path, const char *filename, bool checkInputs)
+{
+   if (read(path,filename)) return true;
+   return parse(checkInputs);
 };
 
+// One pass over the file to index the Material blocks by name without parsing them.
+// Returns true if the layout is not clean or a name repeats, in which case the whole file
+// is parsed to report the errors.
+bool MaterialDatabase::scan()
+{
+   blockIndex.clear();
+
+   int start=-1;
+   string terminator="";   // of the nested block being skipped
+   string name;
+   bool hasName=false;
+
+   // skip the version line
+   long unsigned int i=1;
+   while (i < inputs.get_size()) {
+      int lineNumber=inputs.get_lineNumber(i);
+      string_view line=inputs.get_text(i);
+
+      if (start < 0) {
+         if (line.compare("Material") != 0) return true;
+         start=lineNumber;
+         hasName=false;
+      } else if (terminator.compare("") != 0) {
+         if (line.compare(terminator) == 0) terminator="";
+         else if (line.compare("Material") == 0 || line.compare("EndMaterial") == 0) return true;
+      } else if (line.compare("Temperature") == 0) {
+         terminator="EndTemperature";
+      } else if (line.compare("Source") == 0) {
+         terminator="EndSource";
+      } else if (line.compare("EndMaterial") == 0) {
+         if (!hasName || blockIndex.find(name) != blockIndex.end()) return true;
+         blockIndex[name]=make_pair(start,lineNumber);
+         start=-1;
+      } else if (line.compare("Material") == 0) {
+         return true;
+      } else {
+         size_t equal=line.find("=");
+         if (equal != string::npos) {
+            string_view token=line.substr(0,line.find_last_not_of(" \t",equal-1)+1);
+            if (token.compare("name") == 0) {
+               if (hasName) return true;
+               size_t first=line.find_first_not_of(" \t",equal+1);
+               if (first == string::npos) name="";
+               else name=line.substr(first);
+               hasName=true;
+            }
+         }
+      }
+      i++;
+   }
+
+   if (start >= 0) return true;
+   return false;
+}
+
+// Index the materials in the file and parse only those in names, leaving the others to be parsed on first use by get.
+// Names not in the file are skipped since they can come from a local file.
+// return true on fail
+bool MaterialDatabase::load_lazy(const char *path, const char *filename, bool checkInputs, vector<string> *names)
+{
+   if (read(path,filename)) return true;
+   if (scan()) return parse(checkInputs);
+
+   isLazy=true;
+   checkLimits=checkInputs;
+
+   bool fail=false;
+   long unsigned int i=0;
+   while (i < names->size()) {
+      if (blockIndex.find((*names)[i]) != blockIndex.end()) {
+         if (!get((*names)[i])) fail=true;
+      }
+      i++;
+   }
+
+   if (fail) {
+      prefix(); PetscPrintf(PETSC_COMM_WORLD,"%s%sERROR1151: Failed to load materials.\n",indent.c_str(),indent.c_str());
+   }
+
+   return fail;
+}
+
+void MaterialDatabase::push (Material *a)
+{
+   materialList.push_back(a);
+   nameIndex.emplace(a->get_name()->get_value(),materialList.size()-1);
+}
+
+// with lazy loading, a material not yet parsed is parsed and checked here
 Material* MaterialDatabase::get(string name)
 {
+   unordered_map<string,long unsigned int>::iterator it=nameIndex.find(name);
+   if (it != nameIndex.end()) return materialList[it->second];
+
+   if (!isLazy) return nullptr;
+
+   unordered_map<string,pair<int,int>>::iterator block=blockIndex.find(name);
+   if (block == blockIndex.end()) return nullptr;
+
+   Material *material=new Material(block->second.first,block->second.second);
+   blockIndex.erase(block);
+
+   bool fail=false;
+   if (material->load(&indent,&inputs,checkLimits)) fail=true;
+   if (material->check(indent)) fail=true;
+
+   if (fail) {
+      prefix(); PetscPrintf(PETSC_COMM_WORLD,"%s%sERROR1142: Failed to load material \"%s\" at line %d.\n",
+                                             indent.c_str(),indent.c_str(),name.c_str(),material->get_startLine());
+      delete material;
+      return nullptr;
+   }
+
+   material->compile();
+   push(material);
+   return material;
+}
+
+// Check the compiled evaluators against the linear ones over count log-spaced frequencies from 1 MHz to 1 THz
+// plus the tabulated frequencies, and report the speedup.  Passes if every value matches exactly.
+void MaterialDatabase::test_evaluators (int count)
+{
+   vector<double> frequencies;
+   int i=0;
+   while (i < count) {
+      frequencies.push_back(1e6*pow(10,6.0*i/count));
+      i++;
+   }
+
+   double linearTime=0;
+   double compiledTime=0;
+   long unsigned int mismatches=0;
+   long unsigned int j=0;
+   while (j < materialList.size()) {
+      mismatches+=materialList[j]->test_evaluators(&frequencies,tol,&linearTime,&compiledTime);
+      j++;
+   }
+
+   prefix(); PetscPrintf(PETSC_COMM_WORLD,"%smaterial evaluators: %ld mismatches, linear %g s, compiled %g s, speedup %g\n",
+                                          indent.c_str(),mismatches,linearTime,compiledTime,compiledTime > 0 ? linearTime/compiledTime : 0);
+   if (mismatches == 0) {prefix(); PetscPrintf(PETSC_COMM_WORLD,"%smaterial evaluators pass\n",indent.c_str());}
+   else {prefix(); PetscPrintf(PETSC_COMM_WORLD,"%smaterial evaluators FAIL\n",indent.c_str());}
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////
+// workerPool
+///////////////////////////////////////////////////////////////////////////////////////////
+
+void workerPool::work (long unsigned int index, long unsigned int seen)
+{
+   while (true) {
+      function<void(long unsigned int)> task;
+      {
+         unique_lock<mutex> guard(lock);
+         startSignal.wait(guard,[&]() {return stopping || generation != seen;});
+         if (stopping) return;
+         seen=generation;
+         task=job;
+      }
+
+      task(index);
+
+      unique_lock<mutex> guard(lock);
+      running--;
+      if (running == 0) doneSignal.notify_one();
+   }
+}
+
+void workerPool::stop ()
+{
+   {
+      unique_lock<mutex> guard(lock);
+      stopping=true;
+   }
+   startSignal.notify_all();
+
+   long unsigned int i=0;
+   while (i < threadList.size()) {
+      threadList[i].join();
+      i++;
+   }
+   threadList.clear();
+   stopping=false;
+}
+
+// count threads including the calling thread
+void workerPool::resize (long unsigned int count)
+{
+   if (count < 1) count=1;
+   if (count == size()) return;
+
+   stop();
+   long unsigned int i=1;
+   while (i < count) {
+      threadList.push_back(thread(&workerPool::work,this,i,generation));
+      i++;
+   }
+}
+
+void workerPool::run (function<void(long unsigned int)> task)
+{
+   if (threadList.size() == 0) {
+      task(0);
+      return;
+   }
+
+   {
+      unique_lock<mutex> guard(lock);
+      job=task;
+      running=threadList.size();
+      generation++;
+   }
+   startSignal.notify_all();
+
+   task(0);
+
+   unique_lock<mutex> guard(lock);
+   doneSignal.wait(guard,[&]() {return running == 0;});
+   job=nullptr;
+}
+
+// threads used by evaluate, including the calling thread, capped at the hardware threads
+// the default of 1 suits one rank per core
+void MaterialDatabase::set_threads (int count)
+{
+   long unsigned int hardwareCount=thread::hardware_concurrency();
+   if (hardwareCount == 0) hardwareCount=1;
+
+   long unsigned int threadCount=1;
+   if (count > 1) threadCount=count;
+   if (threadCount > hardwareCount) threadCount=hardwareCount;
+
+   workers.resize(threadCount);
+}
+
+// Fill eps[i][k], mu[i][k], and Rs[i][k] for material names[i] at frequencies[k], such as all of the
+// frequencies in a FrequencyPlan, with the materials split across the threads from set_threads.
+// Returns true if a material or its temperature block is not found.
+bool MaterialDatabase::evaluate (vector<string> *names, double temperature, vector<double> *frequencies,
+                                 vector<vector<complex<double>>> *eps, vector<vector<double>> *mu, vector<vector<double>> *Rs)
+{
+   bool fail=false;
+
+   eps->resize(names->size());
+   mu->resize(names->size());
+   Rs->resize(names->size());
+
+   // resolve on this thread since lookup failures print
+   vector<Temperature *> temperatureList(names->size(),nullptr);
+   long unsigned int i=0;
+   while (i < names->size()) {
+      Material *material=get((*names)[i]);
+      if (material) {
+         temperatureList[i]=material->get_temperature(temperature,tol,indent);
+         if (temperatureList[i]) {
+            if (!temperatureList[i]->is_compiled()) temperatureList[i]->compile();
+         } else fail=true;
+      } else {
+         prefix(); PetscPrintf(PETSC_COMM_WORLD,"%sERROR1140: Material \"%s\" is not in the material database.\n",indent.c_str(),(*names)[i].c_str());
+         fail=true;
+      }
+      i++;
+   }
+   if (fail) return fail;
+
+   long unsigned int threadCount=workers.size();
+   workers.run([=,&temperatureList](long unsigned int t) {
+      long unsigned int j=t;
+      while (j < temperatureList.size()) {
+         temperatureList[j]->evaluate(frequencies,tol,&((*eps)[j]),&((*mu)[j]),&((*Rs)[j]));
+         j+=threadCount;
+      }
+   });
+
+   return fail;
+}
+
+static void cache_hash_bytes (unsigned long long *hash, const void *data, size_t length)
+{
+   const unsigned char *bytes=(const unsigned char *)data;
+   size_t i=0;
+   while (i < length) {
+      *hash^=bytes[i];
+      *hash*=1099511628211ULL;
+      i++;
+   }
+}
+
+static void cache_hash_file (unsigned long long *hash, const char *path, const char *filename)
+{
+   string fullPathName=string(path)+string(filename);
+   cache_hash_bytes(hash,fullPathName.c_str(),fullPathName.size()+1);
+
+   ifstream file(fullPathName,ios::binary);
+   if (!file.is_open()) {
+      cache_hash_bytes(hash,"missing",7);
+      return;
+   }
+
+   stringstream buffer;
+   buffer << file.rdbuf();
+   string contents=buffer.str();
+   size_t length=contents.size();
+   cache_hash_bytes(hash,&length,sizeof(size_t));
+   cache_hash_bytes(hash,contents.data(),length);
+}
+
+// key for the cache built from the text of the materials files and the settings that affect loading
+unsigned long long MaterialDatabase::cache_key (char *global_path, char *global_name, char *local_path, char *local_name, bool check_limits)
+{
+   unsigned long long hash=14695981039346656037ULL;
+
+   // only rank 0 reads the files when loading collectively
+   int rank=0;
+   if (inputs.is_collective()) MPI_Comm_rank(inputs.get_comm(),&rank);
+   if (rank != 0) {
+      MPI_Bcast(&hash,1,MPI_UNSIGNED_LONG_LONG,0,inputs.get_comm());
+      return hash;
+   }
+
+   int cacheVersion=MATERIALS_CACHE_VERSION;
+   cache_hash_bytes(&hash,&cacheVersion,sizeof(int));
+   cache_hash_bytes(&hash,version_name.c_str(),version_name.size()+1);
+   cache_hash_bytes(&hash,version_value.c_str(),version_value.size()+1);
+   cache_hash_bytes(&hash,&check_limits,sizeof(bool));
+   if (strlen(global_name) != 0) cache_hash_file(&hash,global_path,global_name);
+   cache_hash_bytes(&hash,"|",1);
+   if (strlen(local_name) != 0) cache_hash_file(&hash,local_path,local_name);
+
+   if (inputs.is_collective()) MPI_Bcast(&hash,1,MPI_UNSIGNED_LONG_LONG,0,inputs.get_comm());
+   return hash;
+}
+
+// write the loaded materials as a binary image tagged with key
+// return true on fail
+bool MaterialDatabase::save_cache (const char *filename, unsigned long long key)
+{
+   string image;
+   image_put_string(&image,cache_name);
+   int cacheVersion=MATERIALS_CACHE_VERSION;
+   image_put(&image,&cacheVersion,sizeof(int));
+   image_put(&image,&key,sizeof(unsigned long long));
+   image_put(&image,&tol,sizeof(double));
+
+   size_t count=materialList.size();
+   image_put(&image,&count,sizeof(size_t));
    long unsigned int i=0;
    while (i < materialList.size()) {
-      if (materialList[i]->get_name()->get_value().compare(name) == 0) return materialList[i];
+      materialList[i]->save(&image);
       i++;
    }
-   return nullptr;
+
+   // write then rename so that a reader never sees a partial image
+   string temporaryName=string(filename)+".tmp";
+   ofstream cache(temporaryName,ios::binary|ios::trunc);
+   if (!cache.is_open()) return true;
+   cache.write(image.data(),image.size());
+   cache.close();
+   if (cache.fail()) {remove(temporaryName.c_str()); return true;}
+
+   if (rename(temporaryName.c_str(),filename)) {remove(temporaryName.c_str()); return true;}
+
+   return false;
+}
+
+// restore the materials from a binary image written by save_cache
+// return true on fail, including an image built from different materials files
+bool MaterialDatabase::restore_cache (const char *position, const char *end, unsigned long long key)
+{
+   bool fail=false;
+   string name;
+   int cacheVersion;
+   unsigned long long cacheKey;
+   double cacheTol;
+   size_t count=0;
+
+   if (image_get_string(&position,end,&name) || name.compare(cache_name) != 0) fail=true;
+   if (!fail && (image_get(&position,end,&cacheVersion,sizeof(int)) || cacheVersion != MATERIALS_CACHE_VERSION)) fail=true;
+   if (!fail && (image_get(&position,end,&cacheKey,sizeof(unsigned long long)) || cacheKey != key)) fail=true;
+   if (!fail && image_get(&position,end,&cacheTol,sizeof(double))) fail=true;
+   if (!fail && image_get(&position,end,&count,sizeof(size_t))) fail=true;
+
+   vector<Material *> restoredList;
+   long unsigned int i=0;
+   while (!fail && i < count) {
+      Material *material=new Material();
+      restoredList.push_back(material);
+      if (material->restore(&position,end)) fail=true;
+      i++;
+   }
+   if (position != end) fail=true;
+
+   if (fail) {
+      i=0;
+      while (i < restoredList.size()) {
+         delete restoredList[i];
+         i++;
+      }
+      return true;
+   }
+
+   tol=cacheTol;
+   i=0;
+   while (i < restoredList.size()) {
+      restoredList[i]->compile();
+      push(restoredList[i]);
+      i++;
+   }
+
+   return false;
+}
+
+// load the materials from a binary image written by save_cache
+// when loading collectively, rank 0 reads the image and broadcasts it so that only one rank opens it
+// return true on fail, including a missing image or one built from different materials files
+bool MaterialDatabase::load_cache (const char *filename, unsigned long long key)
+{
+   if (inputs.is_collective()) {
+      int rank;
+      MPI_Comm_rank(inputs.get_comm(),&rank);
+
+      string image;
+      bool readFail=false;
+      if (rank == 0) {
+         ifstream cache(filename,ifstream::in|ifstream::binary);
+         if (cache.is_open()) {
+            cache.seekg(0,ios::end);
+            streamoff fileSize=cache.tellg();
+            cache.seekg(0,ios::beg);
+            if (fileSize > 0) {
+               image.resize(fileSize);
+               cache.read(&(image[0]),fileSize);
+               if (cache.gcount() != fileSize) readFail=true;
+            } else readFail=true;
+         } else readFail=true;
+      }
+
+      if (broadcast_buffer(&image,readFail,inputs.get_comm())) return true;
+      return restore_cache(image.data(),image.data()+image.size(),key);
+   }
+
+   int fd=open(filename,O_RDONLY);
+   if (fd < 0) return true;
+
+   struct stat status;
+   if (fstat(fd,&status) || status.st_size == 0) {close(fd); return true;}
+
+   void *map=mmap(nullptr,status.st_size,PROT_READ,MAP_PRIVATE,fd,0);
+   close(fd);
+   if (map == MAP_FAILED) return true;
+
+   bool fail=restore_cache((const char *)map,(const char *)map+status.st_size,key);
+   munmap(map,status.st_size);
+
+   return fail;
+}
+
+// Loads the materials from the binary cache at cache_filename when it was built from the same
+// materials files.  Otherwise the files are parsed and, when they load cleanly, rank 0 writes the cache.
+bool MaterialDatabase::load_materials_cached (char *global_path, char *global_name, char *local_path, char *local_name, bool check_limits, const char *cache_filename)
+{
+   unsigned long long key=cache_key(global_path,global_name,local_path,local_name,check_limits);
+
+   // the same on all ranks when loading collectively, since all ranks restore rank 0's image
+   bool cacheFail=load_cache(cache_filename,key);
+
+   if (!cacheFail) {
+      prefix(); PetscPrintf(PETSC_COMM_WORLD,"%sloaded materials cache \"%s\"\n",indent.c_str(),cache_filename);
+      return false;
+   }
+
+   if (load_materials(global_path,global_name,local_path,local_name,check_limits)) return true;
+
+   if (isComplete) {
+      int rank;
+      MPI_Comm_rank(PETSC_COMM_WORLD,&rank);
+      if (rank == 0 && save_cache(cache_filename,key)) {
+         prefix(); PetscPrintf(PETSC_COMM_WORLD,"%sWarning: Failed to write the materials cache \"%s\".\n",indent.c_str(),cache_filename);
+      }
+   }
+
+   return false;
 }
 
 void MaterialDatabase::print(string indent)
@@ -1331,6 +2240,7 @@ void MaterialDatabase::print(string indent)
    }
 }
 
+// also builds the name index
 bool MaterialDatabase::check()
 {
    bool fail=false;
@@ -1340,6 +2250,7 @@ bool MaterialDatabase::check()
       fail=true;
    }
 
+   nameIndex.clear();
    long unsigned int i=0;
    while (i < materialList.size()) {
 
@@ -1347,14 +2258,11 @@ bool MaterialDatabase::check()
       if (materialList[i]->check(indent)) fail=true;
 
       // cross-block checks
-      long unsigned int j=i+1;
-      while (i < materialList.size()-1 && j < materialList.size()) {
-         if (materialList[i]->get_name()->get_value().compare(materialList[j]->get_name()->get_value()) == 0) {
-            prefix(); PetscPrintf(PETSC_COMM_WORLD,"%sERROR1092: name at line %d duplicates the name at line %d.\n",
-                                                   indent.c_str(),materialList[j]->get_name()->get_lineNumber(),materialList[i]->get_name()->get_lineNumber());
-            fail=true;
-         }
-         j++;
+      pair<unordered_map<string,long unsigned int>::iterator,bool> entry=nameIndex.emplace(materialList[i]->get_name()->get_value(),i);
+      if (!entry.second) {
+         prefix(); PetscPrintf(PETSC_COMM_WORLD,"%sERROR1092: name at line %d duplicates the name at line %d.\n",
+                                                indent.c_str(),materialList[i]->get_name()->get_lineNumber(),materialList[entry.first->second]->get_name()->get_lineNumber());
+         fail=true;
       }
       i++;
    }
@@ -1363,14 +2271,24 @@ bool MaterialDatabase::check()
 }
 
 bool MaterialDatabase::load_materials (char *global_path, char *global_name, char *local_path, char *local_name, bool check_limits)
+{
+   return load_materials(global_path,global_name,local_path,local_name,check_limits,nullptr);
+}
+
+// With names, such as from MeshMaterialList::get_names, the global materials library is loaded lazily
+// so that only the named materials are parsed up front.  The local file is always parsed in full.
+// With set_collective, rank 0 reads the files for all ranks.
+bool MaterialDatabase::load_materials (char *global_path, char *global_name, char *local_path, char *local_name, bool check_limits, vector<string> *names)
 {
    bool global=true;
    if (strlen(global_name) != 0) {
-      global=load(global_path,global_name,check_limits);
+      if (names) global=load_lazy(global_path,global_name,check_limits,names);
+      else global=load(global_path,global_name,check_limits);
    }
 
    bool local=true;
    MaterialDatabase localMaterialDatabase;
+   if (inputs.is_collective()) localMaterialDatabase.set_collective(inputs.get_comm());
    if (strlen(local_name) != 0) {
       local=localMaterialDatabase.load(local_path,local_name,check_limits);
    }
@@ -1379,6 +2297,9 @@ bool MaterialDatabase::load_materials (char *global_path, char *global_name, cha
       if (merge(&localMaterialDatabase,get_indent())) return true;
    }
 
+   // every named file parsed in full without error
+   isComplete=!isLazy && (!global || strlen(global_name) == 0) && (!local || strlen(local_name) == 0);
+
    if (!global || !local) return false;
    return true;
 }
@@ -1407,20 +2328,23 @@ bool MaterialDatabase::merge(MaterialDatabase *db, string indent)
    long unsigned int i=0;
    while (i < db->materialList.size()) {
       bool found=false;
-      long unsigned int j=0;
-      while (j < materialList.size()) {
+      unordered_map<string,long unsigned int>::iterator it=nameIndex.find(db->materialList[i]->get_name()->get_value());
+      if (it != nameIndex.end()) {
+         long unsigned int j=it->second;
          if (! materialList[j]->get_merged()) {
-            if (db->materialList[i]->get_name()->get_value().compare(materialList[j]->get_name()->get_value()) == 0) {
-               prefix(); PetscPrintf(PETSC_COMM_WORLD,"%sReplacing duplicate material \"%s\" with the material from the local material database.\n",
-                                                      indent.c_str(),db->materialList[i]->get_name()->get_value().c_str());
-               delete materialList[j];
-               materialList[j]=db->materialList[i];
-               materialList[j]->set_merged(true);
-               found=true;
-               break;
-            }
+            prefix(); PetscPrintf(PETSC_COMM_WORLD,"%sReplacing duplicate material \"%s\" with the material from the local material database.\n",
+                                                   indent.c_str(),db->materialList[i]->get_name()->get_value().c_str());
+            delete materialList[j];
+            materialList[j]=db->materialList[i];
+            materialList[j]->set_merged(true);
+            found=true;
          }
-         j++;
+      }
+
+      // replaces a material that has not been parsed
+      if (!found && blockIndex.erase(db->materialList[i]->get_name()->get_value()) > 0) {
+         prefix(); PetscPrintf(PETSC_COMM_WORLD,"%sReplacing duplicate material \"%s\" with the material from the local material database.\n",
+                                                indent.c_str(),db->materialList[i]->get_name()->get_value().c_str());
       }
 
       if (!found) {
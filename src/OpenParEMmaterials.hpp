@@ -27,6 +27,17 @@
 #include <string>
 #include <limits>
 #include <cfloat>
+#include <algorithm>
+#include <chrono>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <unordered_map>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
 #include "fem.hpp"
 #include "keywordPair.hpp"
 #include "misc.hpp"
@@ -44,6 +55,8 @@ class Frequency
       keywordPair relative_permeability;
       keywordPair loss;                  // loss tangent or conductivity
       keywordPair Rz;                    // surface roughness
+      keywordPair* get_keyword (int);
+      void set_schemas (bool);
    public:
       Frequency (int,int,bool);
       Frequency () {}
@@ -57,9 +70,15 @@ class Frequency
       int get_startLine () {return startLine;}
       void print (string);
       bool check (string);
+      void save (string *);
+      bool restore (const char **, const char *);
 };
 
 
+// loss models, resolved from the loss keyword at load time
+#define LOSS_TANGENT 0
+#define LOSS_CONDUCTIVITY 1
+
 class Temperature
 {
    private:
@@ -73,6 +92,27 @@ class Temperature
       keywordPair m2;
       keywordPair relative_permeability;
       keywordPair loss;                  // loss tangent or conductivity
+
+      // compiled by compile () for evaluation without keyword lookups
+      bool isCompiled=false;
+      bool isAnyFrequency=false;         // single frequency block with frequency=any
+      vector<double> frequencyTable;     // frequency blocks sorted by frequency
+      vector<double> epsTable;
+      vector<double> murTable;
+      vector<double> lossTable;
+      vector<double> RzTable;
+      vector<int> lossModelTable;
+      int lossModel;                     // for Debye
+      double debyeEps;                   // relative_permeability, as used by get_eps_linear
+      double debyeLoss;
+      double debyeM1;                    // 10^m1
+      double debyeM2;                    // 10^m2
+      double debyeInfinity;              // er_infinity*eps0
+      double debyeDelta;                 // delta_er*eps0/(m2-m1)
+      double debyeMu;
+      int lookup (double, double, long unsigned int *);
+      keywordPair* get_keyword (int);
+      void set_schemas (bool);
    public:
       Temperature (int,int,bool);
       Temperature (){}
@@ -83,12 +123,21 @@ class Temperature
       keywordPair* get_temperature () {return &temperature;}
       Frequency* get_frequency (int i) {return frequencyList[i];}
       int get_startLine () {return startLine;}
+      void compile ();
+      bool is_compiled () {return isCompiled;}
+      void evaluate (vector<double> *, double, vector<complex<double>> *, vector<double> *, vector<double> *);
       complex<double> get_eps (double, double, string);
       double get_mu (double, double, string);
       double get_Rs (double, double, string);
+      complex<double> get_eps_linear (double, double, string);
+      double get_mu_linear (double, double, string);
+      double get_Rs_linear (double, double, string);
+      long unsigned int test_evaluators (vector<double> *, double, double *, double *);
       bool load (string *, inputFile *, bool);
       void print (string);
       bool check (string);
+      void save (string *);
+      bool restore (const char **, const char *);
 };
 
 class Source
@@ -103,6 +152,8 @@ class Source
       bool inSourceBlock (int);
       bool load (inputFile *);
       void print (string);
+      void save (string *);
+      bool restore (const char **, const char *);
 };
 
 
@@ -129,33 +180,83 @@ class Material
       keywordPair* get_name () {return &name;}
       int get_startLine () {return startLine;}
       Temperature* get_temperature (double, double, string);
+      void compile ();
+      long unsigned int test_evaluators (vector<double> *, double, double *, double *);
       complex<double> get_eps (double, double, double, string);
       double get_mu (double, double, double, string);
       double get_Rs (double, double, double, string);
       void print (string);
       bool check (string);
+      void save (string *);
+      bool restore (const char **, const char *);
+};
+
+// Threads kept between calls to run so that repeated batch evaluations do not start threads.
+// run calls job(k) for k=0...size()-1, with k=0 on the calling thread, and returns when all are done.
+class workerPool
+{
+   private:
+      vector<thread> threadList;
+      mutex lock;
+      condition_variable startSignal;
+      condition_variable doneSignal;
+      function<void(long unsigned int)> job;
+      long unsigned int generation=0;
+      long unsigned int running=0;
+      bool stopping=false;
+      void work (long unsigned int, long unsigned int);
+      void stop ();
+   public:
+      ~workerPool () {stop();}
+      void resize (long unsigned int);
+      long unsigned int size () {return threadList.size()+1;}
+      void run (function<void(long unsigned int)>);
 };
 
+// bump when the layout written by MaterialDatabase::save_cache changes
+#define MATERIALS_CACHE_VERSION 3
+
 class MaterialDatabase
 {
    private:
       inputFile inputs;
       vector<Material *> materialList;
+      unordered_map<string,long unsigned int> nameIndex;  // first material in materialList with the name
+      unordered_map<string,pair<int,int>> blockIndex;     // Material blocks not yet parsed, by name, for lazy loading
+      bool isLazy=false;
+      bool checkLimits=false;
+      bool isComplete=false;   // all materials parsed and checked without error, so safe to cache
       double tol=1e-12;     // tolerance for floating point matches
       string indent="   ";  // for error messages
       string version_name="#OpenParEMmaterials";
       string version_value="1.0";
+      string cache_name="#OpenParEMmaterialsCache";
       double isTransferred=false;
+      workerPool workers;   // for evaluate
+      bool read (const char *, const char *);
+      bool parse (bool);
+      bool scan ();
+      unsigned long long cache_key (char *, char *, char *, char *, bool);
+      bool restore_cache (const char *, const char *, unsigned long long);
    public:
       ~MaterialDatabase();
+      void set_collective (MPI_Comm comm) {inputs.set_collective(comm);}
       bool load_materials (char *, char *, char *, char *, bool);
+      bool load_materials (char *, char *, char *, char *, bool, vector<string> *);
       bool load (const char *, const char *, bool);
+      bool load_lazy (const char *, const char *, bool, vector<string> *);
+      bool load_materials_cached (char *, char *, char *, char *, bool, const char *);
+      bool save_cache (const char *, unsigned long long);
+      bool load_cache (const char *, unsigned long long);
       bool merge (MaterialDatabase *, string);
-      void push (Material *a) {materialList.push_back(a);}
+      void push (Material *);
       void print (string);
       bool findMaterialBlocks ();
       bool check ();
       Material* get (string);
+      void test_evaluators (int);
+      void set_threads (int);
+      bool evaluate (vector<string> *, double, vector<double> *, vector<vector<complex<double>>> *, vector<vector<double>> *, vector<vector<double>> *);
       double get_tol () {return tol;}
       string get_indent () {return indent;}
 };
@@ -25,7 +25,7 @@ bool loadData (ifstream *eVecFile, double **eVecRe, double **eVecIm, size_t *vec
 {
    string line;
    int lineNumber=0;
-   vector<string> tokens;
+   lineTokenizer tokens;
    bool foundVec=false,foundEndVec=false;
    size_t allocated,length,blockSize=256;
 
@@ -43,21 +43,26 @@ bool loadData (ifstream *eVecFile, double **eVecRe, double **eVecIm, size_t *vec
 
    while (getline(*eVecFile,line)) {
       lineNumber++;
-      split_on_space (&tokens,line);
+      tokens.split(line);
 
       if (foundVec) {
-         if (tokens.size() > 0) if (tokens[0].compare("];") == 0) foundEndVec=true;
+         if (tokens.size() > 0) if (tokens.get(0).compare("];") == 0) foundEndVec=true;
 
          if (! foundEndVec) {
             bool savedValue=false;
 
+            size_t position;
+            int result;
+
             if (tokens.size() == 1) { // real part only
-               try {
-                  (*eVecRe)[*vectorSize]=stod(tokens[0]);
-               } catch(const std::out_of_range&) {
-                  // assume that the number is less than DBL_MIN and set to 0
-                  (*eVecRe)[*vectorSize]=0;
+               result=parse_double(tokens.get(0),&(*eVecRe)[*vectorSize],&position);
+               if (result == PARSE_INVALID) {
+                  prefix(); PetscPrintf(PETSC_COMM_WORLD,"ERROR1143: Invalid number in file \"%s\" at line %d, column %d\n",
+                                                         filename,lineNumber,(int)(tokens.get(0).data()-line.data()+position)+1);
+                  return true;
                }
+               // assume that the number is less than DBL_MIN and set to 0
+               if (result == PARSE_OUT_OF_RANGE) (*eVecRe)[*vectorSize]=0;
                (*eVecIm)[*vectorSize]=0;
 
                savedValue=true;
@@ -67,21 +72,25 @@ bool loadData (ifstream *eVecFile, double **eVecRe, double **eVecIm, size_t *vec
               return true;
             } else if (tokens.size() == 3) {  // complex
 
-               try {
-                  (*eVecRe)[*vectorSize]=stod(tokens[0]);
-               } catch(const std::out_of_range&) {
-                  // assume that the number is less than DBL_MIN and set to 0
-                  (*eVecRe)[*vectorSize]=0;
+               result=parse_double(tokens.get(0),&(*eVecRe)[*vectorSize],&position);
+               if (result == PARSE_INVALID) {
+                  prefix(); PetscPrintf(PETSC_COMM_WORLD,"ERROR1145: Invalid number in file \"%s\" at line %d, column %d\n",
+                                                         filename,lineNumber,(int)(tokens.get(0).data()-line.data()+position)+1);
+                  return true;
                }
-               length=tokens[2].length();
-
-               try {
-                  (*eVecIm)[*vectorSize]=stod(tokens[2].substr(0,length-1));
-               } catch(const std::out_of_range&) {
-                  // assume that the number is less than DBL_MIN and set to 0
-                  (*eVecIm)[*vectorSize]=0;
+               // assume that the number is less than DBL_MIN and set to 0
+               if (result == PARSE_OUT_OF_RANGE) (*eVecRe)[*vectorSize]=0;
+
+               // drop the trailing i
+               length=tokens.get(2).length();
+               result=parse_double(tokens.get(2).substr(0,length-1),&(*eVecIm)[*vectorSize],&position);
+               if (result == PARSE_INVALID) {
+                  prefix(); PetscPrintf(PETSC_COMM_WORLD,"ERROR1146: Invalid number in file \"%s\" at line %d, column %d\n",
+                                                         filename,lineNumber,(int)(tokens.get(2).data()-line.data()+position)+1);
+                  return true;
                }
-               if (tokens[1].compare("-") == 0) (*eVecIm)[*vectorSize]=-(*eVecIm)[*vectorSize];
+               if (result == PARSE_OUT_OF_RANGE) (*eVecIm)[*vectorSize]=0;
+               if (tokens.get(1).compare("-") == 0) (*eVecIm)[*vectorSize]=-(*eVecIm)[*vectorSize];
 
                savedValue=true;
                (*vectorSize)++;
@@ -107,7 +116,7 @@ bool loadData (ifstream *eVecFile, double **eVecRe, double **eVecIm, size_t *vec
          }
 
       } else {
-         if (tokens.size() > 0) {if (tokens[0].substr(0,3).compare("Vec") == 0) foundVec=true;}
+         if (tokens.size() > 0) {if (tokens.get(0).substr(0,3).compare("Vec") == 0) foundVec=true;}
       }
    }
 
@@ -19,6 +19,8 @@
 ////////////////////////////////////////////////////////////////////////////////
 
 #include "frequencyPlan.hpp"
+#include "jobrelated.hpp"
+#include "mesh.hpp"
 
 void FrequencyPlanPoint::print ()
 {
@@ -32,57 +34,113 @@ void FrequencyPlanPoint::print ()
    }
 }
 
-// sort from lowest to highest frequency
+// true if the point was solved on a different mesh
+// the mesh hash decides when both are known, since meshes of equal size can differ
+bool FrequencyPlanPoint::is_stale (int meshSize_, unsigned long long meshHash_)
+{
+   if (meshHash != 0 && meshHash_ != 0) return meshHash != meshHash_;
+   return meshSize != meshSize_;
+}
+
+FrequencySegment::FrequencySegment (struct inputFrequencyPlan *inputFrequencyPlan)
+{
+   type=inputFrequencyPlan->type;
+   start=inputFrequencyPlan->start;
+   stop=inputFrequencyPlan->stop;
+   step=inputFrequencyPlan->step;
+   pointsPerDecade=inputFrequencyPlan->pointsPerDecade;
+
+   // same end tolerance as stepping up to stop*(1+1e-12)
+   double n;
+   if (type == 0) n=floor((stop*(1+1e-12)-start)/step)+1;
+   else n=floor(pointsPerDecade*log10(stop*(1+1e-12)/start))+1;
+
+   // the frequency count limit applies to invalid inputs, and a stop below start is an empty plan
+   if (!(n <= 1e15)) n=1e15;
+   if (n < 0) n=0;
+   count=(long unsigned int)n;
+}
+
+double FrequencySegment::get_frequency (long unsigned int k)
+{
+   double frequency;
+   if (type == 0) frequency=start+k*step;
+   else frequency=start*pow(10,(double)k/(double)pointsPerDecade);
+   if (k == count-1 && abs(frequency-stop) <= 1e-12*stop) frequency=stop;
+   return frequency;
+}
+
+// fractional point number of a frequency
+double FrequencySegment::estimate (double frequency)
+{
+   double k;
+   if (type == 0) k=(frequency-start)/step;
+   else k=pointsPerDecade*log10(frequency/start);
+   if (!(k > 0)) k=0;
+   if (k > count) k=count;
+   return k;
+}
+
+// first point with frequency at or above the given frequency, or size() if none
+long unsigned int FrequencySegment::lower_bound (double frequency)
+{
+   long unsigned int k=(long unsigned int)estimate(frequency);
+   while (k > 0 && get_frequency(k-1) >= frequency) k--;
+   while (k < count && get_frequency(k) < frequency) k++;
+   return k;
+}
+
+// first point with frequency above the given frequency, or size() if none
+long unsigned int FrequencySegment::upper_bound (double frequency)
+{
+   long unsigned int k=(long unsigned int)estimate(frequency);
+   while (k > 0 && get_frequency(k-1) > frequency) k--;
+   while (k < count && get_frequency(k) <= frequency) k++;
+   return k;
+}
+
+// sort from lowest to highest frequency, keeping the input order of equal frequencies
+// called by assemble before build_runs
 void FrequencyPlan::sort()
 {
-   bool found=true;
-   while (found) {
-      found=false;
-      unsigned long int i=0;
-      while (i < planList.size()-1) {
-         unsigned long int j=i+1;
-         while (planList[i]->get_active() && j < planList.size()) {
-            if (planList[j]->get_active() && planList[i]->get_frequency() > planList[j]->get_frequency()) {
-               found=true;
-               FrequencyPlanPoint *temp;
-               temp=planList[j];
-               planList[j]=planList[i];
-               planList[i]=temp;
-            }
-            j++;
-         }
-         i++;
-      }
-   }
+   std::stable_sort(planList.begin(),planList.end(),
+                    [](FrequencyPlanPoint *p, FrequencyPlanPoint *q) {return p->get_frequency() < q->get_frequency();});
 }
 
-// eliminate duplicates
+// Deactivate all but one of each set of equal active frequencies.  The point kept is the one with
+// the lowest non-zero refinement priority, or the first in input order if none refine.
+// Sorts a list of the active points so that equal frequencies are adjacent, so O(n log n).
+// called by assemble before build_runs
 void FrequencyPlan::eliminateDuplicates()
 {
+   vector<FrequencyPlanPoint *> activeList;
    long unsigned int i=0;
-   while (i < planList.size()-1) {
+   while (i < planList.size()) {
+      if (planList[i]->get_active()) activeList.push_back(planList[i]);
+      i++;
+   }
+   std::stable_sort(activeList.begin(),activeList.end(),
+                    [](FrequencyPlanPoint *p, FrequencyPlanPoint *q) {return p->get_frequency() < q->get_frequency();});
+
+   i=0;
+   while (i < activeList.size()) {
+      FrequencyPlanPoint *keep=activeList[i];
       unsigned long int j=i+1;
-      while (planList[i]->get_active() && j < planList.size()) {
-         if (planList[j]->get_active() && abs(planList[i]->get_frequency()-planList[j]->get_frequency())/planList[j]->get_frequency() < 1e-14) {
-            if (planList[j]->get_refinementPriority() > 0) {
-              if (planList[i]->get_refinementPriority() == 0) {
-                 planList[i]->set_active(false);
-                 break;
-              } else {
-                 if (planList[j]->get_refinementPriority() < planList[i]->get_refinementPriority()) {
-                    planList[i]->set_active(false);
-                    break;
-                 }
-              }
-            }
-            planList[j]->set_active(false);
+      while (j < activeList.size() && abs(activeList[j]->get_frequency()-activeList[i]->get_frequency())/activeList[j]->get_frequency() < 1e-14) {
+         int priority=activeList[j]->get_refinementPriority();
+         if (priority > 0 && (keep->get_refinementPriority() == 0 || priority < keep->get_refinementPriority())) {
+            keep->set_active(false);
+            keep=activeList[j];
+         } else {
+            activeList[j]->set_active(false);
          }
          j++;
       }
-      i++;
+      i=j;
    }
 }
 
+// each point restarts refinement, from the initial mesh or from a cached mesh, see get_frequency
 void FrequencyPlan::setAllRefineRestart()
 {
    long unsigned int i=0;
@@ -97,37 +155,356 @@ void FrequencyPlan::setAllRefineRestart()
 
 void FrequencyPlan::setLowRefinementPriority (int priority)
 {
+   if (planSize == 0) return;
+   FrequencyPlanPoint *planPoint=get_point(0);
+   planPoint->set_refinementPriority(priority);
+   if (priority == 1) planPoint->set_restart(true);
+   else planPoint->set_restart(false);
+}
+
+void FrequencyPlan::setHighRefinementPriority (int priority)
+{
+   if (planSize == 0) return;
+   FrequencyPlanPoint *planPoint=get_point(planSize-1);
+   planPoint->set_refinementPriority(priority);
+   if (priority == 1) planPoint->set_restart(true);
+   else planPoint->set_restart(false);
+}
+
+// Lay out the plan in frequency order from the sorted points and the segments, with each segment
+// split around the points that fall within it.  A point that coincides with a segment point takes
+// its place.  Segments must be sorted and must not overlap except at a shared end point.
+void FrequencyPlan::build_runs ()
+{
+   runList.clear();
+
+   long unsigned int p=0;
+   long unsigned int s=0;
+   while (s < segmentList.size()) {
+      FrequencySegment *segment=&(segmentList[s]);
+      long unsigned int k=0;
+
+      // shared end point with the previous segment
+      if (s > 0 && segmentList[s-1].size() > 0 && segment->size() > 0 &&
+          abs(segment->get_frequency(0)-segmentList[s-1].get_frequency(segmentList[s-1].size()-1)) < 1e-14*segment->get_frequency(0)) k=1;
+
+      if (k < segment->size()) {
+         double low=segment->get_frequency(k)*(1-1e-14);
+         double high=segment->get_frequency(segment->size()-1)*(1+1e-14);
+
+         while (p < planList.size()) {
+            if (planList[p]->get_active()) {
+               double frequency=planList[p]->get_frequency();
+               if (frequency > high) break;
+               if (frequency >= low) {
+                  long unsigned int j=segment->lower_bound(frequency*(1-1e-14));
+                  if (j < k) j=k;
+                  if (j > k) runList.push_back({(long int)s,k,j-k,nullptr,0});
+                  k=j;
+                  if (k < segment->size() && abs(segment->get_frequency(k)-frequency) < 1e-14*frequency) k++;
+               }
+               runList.push_back({-1,0,1,planList[p],0});
+            }
+            p++;
+         }
+
+         if (k < segment->size()) runList.push_back({(long int)s,k,segment->size()-k,nullptr,0});
+      }
+      s++;
+   }
+
+   while (p < planList.size()) {
+      if (planList[p]->get_active()) runList.push_back({-1,0,1,planList[p],0});
+      p++;
+   }
+
+   index_runs();
+}
+
+void FrequencyPlan::index_runs ()
+{
+   planSize=0;
+   long unsigned int r=0;
+   while (r < runList.size()) {
+      runList[r].offset=planSize;
+      planSize+=runList[r].count;
+      r++;
+   }
+}
+
+// run holding the plan index
+long unsigned int FrequencyPlan::find_run (long unsigned int index)
+{
+   vector<FrequencyRun>::iterator it=std::upper_bound(runList.begin(),runList.end(),index,
+                                                      [](long unsigned int i,const FrequencyRun &run) {return i < run.offset;});
+   return (it-runList.begin())-1;
+}
+
+// frequency of entry j in run r
+double FrequencyPlan::run_frequency (long unsigned int r, long unsigned int j)
+{
+   if (runList[r].segment < 0) return runList[r].point->get_frequency();
+   return segmentList[runList[r].segment].get_frequency(runList[r].first+j);
+}
+
+// plan index of the entry within a relative tolerance of the frequency
+bool FrequencyPlan::find_index (double frequency, double tolerance, long unsigned int *index)
+{
+   double low=frequency*(1-tolerance);
+
+   // first run that reaches the low end
+   vector<FrequencyRun>::iterator it=std::partition_point(runList.begin(),runList.end(),
+                                                          [&](const FrequencyRun &run) {return run_frequency(&run-runList.data(),run.count-1) < low;});
+   if (it == runList.end()) return false;
+
+   long unsigned int r=it-runList.begin();
+   long unsigned int j=0;
+   if (runList[r].segment >= 0) {
+      long unsigned int k=segmentList[runList[r].segment].lower_bound(low);
+      if (k > runList[r].first) j=k-runList[r].first;
+      if (j >= runList[r].count) j=runList[r].count-1;
+   }
+
+   if (abs(run_frequency(r,j)-frequency) > tolerance*frequency) return false;
+   *index=runList[r].offset+j;
+   return true;
+}
+
+// add a point to the runs in frequency order after any equal entries, splitting a segment run as needed
+// call index_runs after the additions
+void FrequencyPlan::insert_point (FrequencyPlanPoint *planPoint)
+{
+   double frequency=planPoint->get_frequency();
+
+   vector<FrequencyRun>::iterator it=std::partition_point(runList.begin(),runList.end(),
+                                                          [&](const FrequencyRun &run) {return run_frequency(&run-runList.data(),run.count-1) <= frequency;});
+   long unsigned int r=it-runList.begin();
+
+   if (r == runList.size() || runList[r].segment < 0 || run_frequency(r,0) > frequency) {
+      runList.insert(runList.begin()+r,{-1,0,1,planPoint,0});
+      return;
+   }
+
+   long unsigned int k=segmentList[runList[r].segment].upper_bound(frequency);
+   FrequencyRun high={runList[r].segment,k,runList[r].first+runList[r].count-k,nullptr,0};
+   runList[r].count=k-runList[r].first;
+   runList.insert(runList.begin()+r+1,{-1,0,1,planPoint,0});
+   runList.insert(runList.begin()+r+2,high);
+}
+
+double FrequencyPlan::frequency_at (long unsigned int index)
+{
+   long unsigned int r=find_run(index);
+   return run_frequency(r,index-runList[r].offset);
+}
+
+// the state record for the plan index, or nullptr if the point has not been materialized
+FrequencyPlanPoint* FrequencyPlan::find_point (long unsigned int index)
+{
+   long unsigned int r=find_run(index);
+   if (runList[r].segment < 0) return runList[r].point;
+
+   map<pair<long unsigned int,long unsigned int>,FrequencyPlanPoint *>::iterator it;
+   it=generatedList.find(make_pair(runList[r].segment,runList[r].first+index-runList[r].offset));
+   if (it == generatedList.end()) return nullptr;
+   return it->second;
+}
+
+// the state record for the plan index, materialized from its segment as needed
+FrequencyPlanPoint* FrequencyPlan::get_point (long unsigned int index)
+{
+   FrequencyPlanPoint *planPoint=find_point(index);
+   if (planPoint) return planPoint;
+
+   long unsigned int r=find_run(index);
+   long unsigned int k=runList[r].first+index-runList[r].offset;
+
+   planPoint=new FrequencyPlanPoint;
+   planPoint->set_frequency(segmentList[runList[r].segment].get_frequency(k));
+   planPoint->set_refinementPriority(0);
+   planPoint->set_restart(true);
+   planPoint->set_simulated(false);
+   planPoint->set_active(true);
+   planPoint->set_meshSize(0);
+   generatedList[make_pair(runList[r].segment,k)]=planPoint;
+
+   return planPoint;
+}
+
+// materialized points with their plan indices in frequency order
+void FrequencyPlan::get_materialized (vector<pair<long unsigned int,FrequencyPlanPoint *>> *pointList)
+{
+   pointList->clear();
+   long unsigned int r=0;
+   while (r < runList.size()) {
+      if (runList[r].segment < 0) pointList->push_back(make_pair(runList[r].offset,runList[r].point));
+      else {
+         map<pair<long unsigned int,long unsigned int>,FrequencyPlanPoint *>::iterator it;
+         it=generatedList.lower_bound(make_pair(runList[r].segment,runList[r].first));
+         while (it != generatedList.end() && it->first.first == (long unsigned int)runList[r].segment &&
+                it->first.second < runList[r].first+runList[r].count) {
+            pointList->push_back(make_pair(runList[r].offset+it->first.second-runList[r].first,it->second));
+            it++;
+         }
+      }
+      r++;
+   }
+}
+
+void FrequencyScheduler::build (FrequencyPlan *plan_, char *refinement_frequency)
+{
+   plan=plan_;
+   refineAll=false;
+   if (strcmp(refinement_frequency,"all") == 0) refineAll=true;
+   rebuild();
+}
+
+// re-index after points are added to the plan or restored
+// only materialized points can be refining or simulated
+void FrequencyScheduler::rebuild ()
+{
+   refinementQueue=priority_queue<pair<int,long unsigned int>,vector<pair<int,long unsigned int>>,greater<pair<int,long unsigned int>>>();
+   refinedList.clear();
+   anchor=-1;
+   reset_sweep();
+   refining=false;
+
+   vector<pair<long unsigned int,FrequencyPlanPoint *>> pointList;
+   plan->get_materialized(&pointList);
+
+   int anchorPriority=0;
    long unsigned int i=0;
-   while (i < planList.size()) {
-      if (planList[i]->get_active()) {
-         planList[i]->set_refinementPriority(priority);
-         if (priority == 1) planList[i]->set_restart(true);
-         else planList[i]->set_restart(false);
-         break;
+   while (i < pointList.size()) {
+      FrequencyPlanPoint *planPoint=pointList[i].second;
+      if (planPoint->get_active() && planPoint->get_refinementPriority() > 0) {
+         refining=true;
+         if (!planPoint->get_simulated()) refinementQueue.push(make_pair(planPoint->get_refinementPriority(),pointList[i].first));
+         else {
+            refinedList.push_back(pointList[i].first);
+            if (planPoint->get_refinementPriority() > anchorPriority) {
+               anchorPriority=planPoint->get_refinementPriority();
+               anchor=pointList[i].first;
+            }
+         }
       }
       i++;
    }
 }
 
-void FrequencyPlan::setHighRefinementPriority (int priority)
+// lowest priority refinement point not yet simulated
+FrequencyPlanPoint* FrequencyScheduler::next_refinement ()
 {
-   long unsigned int i=planList.size()-1;
-   while (i >= 0) {
-      if (planList[i]->get_active()) {
-         planList[i]->set_refinementPriority(priority);
-         if (priority == 1) planList[i]->set_restart(true);
-         else planList[i]->set_restart(false);
-         break;
+   while (!refinementQueue.empty()) {
+      long unsigned int i=refinementQueue.top().second;
+      refinementQueue.pop();
+      FrequencyPlanPoint *planPoint=plan->get_point(i);
+      if (!planPoint->get_simulated()) {
+         refinedList.push_back(i);
+         anchor=i;
+         return planPoint;
+      }
+   }
+   return nullptr;
+}
+
+// only refined points can have been simulated before the sweep starts, so only those need re-checking
+void FrequencyScheduler::invalidate (int meshSize, unsigned long long meshHash)
+{
+   long unsigned int i=0;
+   while (i < refinedList.size()) {
+      FrequencyPlanPoint *planPoint=plan->get_point(refinedList[i]);
+      if (planPoint->is_stale(meshSize,meshHash)) planPoint->set_simulated(false);
+      i++;
+   }
+   refinedList.clear();
+   reset_sweep();
+}
+
+// next plan index in sweep order, false at the end of the sweep
+bool FrequencyScheduler::next_index (long unsigned int *index)
+{
+   long unsigned int n=plan->size();
+
+   if (ordering == ORDER_OUTWARD && anchor >= 0) {
+      if (cursor >= n) return false;
+      if (cursor < n-anchor) *index=anchor+cursor;
+      else *index=n-1-cursor;
+      cursor++;
+      return true;
+   }
+
+   if (ordering == ORDER_BISECTION && n > 2) {
+      long unsigned int last=n-1;
+      if (cursor < 2) {
+         if (cursor == 0) *index=0;
+         else *index=last;
+         cursor++;
+         return true;
+      }
+
+      // breadth first over the intervals, with interval i of a level found by halving [0,last]
+      // along the bits of i
+      while (level < 63) {
+         while (interval < (1UL << level)) {
+            long unsigned int low=0;
+            long unsigned int high=last;
+            int bit=level-1;
+            while (bit >= 0) {
+               long unsigned int middle=(low+high)/2;
+               if ((interval >> bit) & 1) low=middle;
+               else high=middle;
+               bit--;
+            }
+            interval++;
+            if (high-low > 1) {
+               levelSplit=true;
+               *index=(low+high)/2;
+               return true;
+            }
+         }
+         if (!levelSplit) return false;
+         level++;
+         interval=0;
+         levelSplit=false;
       }
-      if (i == 0) break;
-      i--;
+      return false;
    }
+
+   if (cursor >= n) return false;
+   *index=cursor;
+   cursor++;
+   return true;
+}
+
+// next active point not yet simulated in sweep order
+FrequencyPlanPoint* FrequencyScheduler::next_sweep ()
+{
+   long unsigned int i;
+   while (next_index(&i)) {
+      FrequencyPlanPoint *planPoint=plan->find_point(i);
+      if (planPoint && (!planPoint->get_active() || planPoint->get_simulated())) continue;
+      return plan->get_point(i);
+   }
+   return nullptr;
 }
 
+// true if the next call to next_refinement returns a point
+bool FrequencyScheduler::refinement_pending ()
+{
+   while (!refinementQueue.empty()) {
+      if (!plan->get_point(refinementQueue.top().second)->get_simulated()) return true;
+      refinementQueue.pop();
+   }
+   return false;
+}
+
+// Linear and log plans are held as segments unless their points refine, and a point is materialized
+// when it is refined, handed out, or restored.
 // ToDo: Add in the stop frequency for linear and log plans to guarantee that they are included.
 bool FrequencyPlan::assemble(char *refinement_frequency, unsigned long int inputFrequencyPlansCount, struct inputFrequencyPlan *inputFrequencyPlans)
 {
    unsigned long int LIMIT=10000000;
+   unsigned long int count=0;
    refinedCount=0;
    hasRefined=false;
    int refinementPriority=1;
@@ -135,50 +512,73 @@ bool FrequencyPlan::assemble(char *refinement_frequency, unsigned long int input
    // add in the frequencies from the frequency plans in projData
    unsigned long int i=0;
    while (i < inputFrequencyPlansCount) {
-      if (inputFrequencyPlans[i].type == 0) {
-         double frequency=inputFrequencyPlans[i].start;
-         while (frequency <= inputFrequencyPlans[i].stop*(1+1e-12)) {
+      if (inputFrequencyPlans[i].type == 0 || inputFrequencyPlans[i].type == 1) {
 
-            FrequencyPlanPoint *planPoint=new FrequencyPlanPoint;
-            planList.push_back(planPoint);
+         // stepping would never reach the stop frequency
+         if (inputFrequencyPlans[i].type == 0 && !(inputFrequencyPlans[i].step > 0)) {
+            prefix(); PetscPrintf(PETSC_COMM_WORLD,"ERROR1153: Linear frequency plan at line %d must have a positive step.\n",
+                                  inputFrequencyPlans[i].lineNumber);
+            return true;
+         }
+         if (inputFrequencyPlans[i].type == 1 && inputFrequencyPlans[i].pointsPerDecade <= 0) {
+            prefix(); PetscPrintf(PETSC_COMM_WORLD,"ERROR1154: Log frequency plan at line %d must have a positive number of points per decade.\n",
+                                  inputFrequencyPlans[i].lineNumber);
+            return true;
+         }
 
-            if (planList.size() > LIMIT) {
-               prefix(); PetscPrintf(PETSC_COMM_WORLD,"ERROR1014: Excessive frequency count > %ld.\n",LIMIT);
-               return true;
-            }
+         FrequencySegment segment(&(inputFrequencyPlans[i]));
 
-            planPoint->set_frequency(frequency);
+         count+=segment.size();
+         if (count > LIMIT) {
+            prefix();
+            if (inputFrequencyPlans[i].type == 0) PetscPrintf(PETSC_COMM_WORLD,"ERROR1014: Excessive frequency count > %ld.\n",LIMIT);
+            else PetscPrintf(PETSC_COMM_WORLD,"ERROR1109: Excessive frequency count > %ld.\n",LIMIT);
+            return true;
+         }
 
-            if (strcmp(refinement_frequency,"plan") == 0 && 
-                inputFrequencyPlans[i].refine == 1) {
-               planPoint->set_refinementPriority(refinementPriority);
-               if (refinementPriority == 1) planPoint->set_restart(true);
-               else planPoint->set_restart(false);
-               refinementPriority++;
-            } else {
-               planPoint->set_refinementPriority(0);
-               planPoint->set_restart(true);
-            }
+         // each point carries its own refinement priority
+         if (strcmp(refinement_frequency,"all") == 0 ||
+             (strcmp(refinement_frequency,"plan") == 0 && inputFrequencyPlans[i].refine == 1)) {
+            long unsigned int k=0;
+            while (k < segment.size()) {
 
-            planPoint->set_simulated(false);
-            planPoint->set_active(true);
+               FrequencyPlanPoint *planPoint=new FrequencyPlanPoint;
+               planList.push_back(planPoint);
+
+               planPoint->set_frequency(segment.get_frequency(k));
 
-            frequency+=inputFrequencyPlans[i].step;
+               if (strcmp(refinement_frequency,"plan") == 0 &&
+                   inputFrequencyPlans[i].refine == 1) {
+                  planPoint->set_refinementPriority(refinementPriority);
+                  if (refinementPriority == 1) planPoint->set_restart(true);
+                  else planPoint->set_restart(false);
+                  refinementPriority++;
+               } else {
+                  planPoint->set_refinementPriority(0);
+                  planPoint->set_restart(true);
+               }
+
+               planPoint->set_simulated(false);
+               planPoint->set_active(true);
+               planPoint->set_meshSize(0);
+
+               k++;
+            }
+         } else {
+            segmentList.push_back(segment);
          }
-      } else if (inputFrequencyPlans[i].type == 1) {
-         double factor=pow(10,1.0/(double)inputFrequencyPlans[i].pointsPerDecade);
-         double frequency=inputFrequencyPlans[i].start;
-         while (frequency <= inputFrequencyPlans[i].stop*(1+1e-12)) {
+      } else if (inputFrequencyPlans[i].type == 2) {
 
             FrequencyPlanPoint *planPoint=new FrequencyPlanPoint;
             planList.push_back(planPoint);
 
-            if (planList.size() > LIMIT) {
-               prefix(); PetscPrintf(PETSC_COMM_WORLD,"ERROR1109: Excessive frequency count > %ld.\n",LIMIT);
+            count++;
+            if (count > LIMIT) {
+               prefix(); PetscPrintf(PETSC_COMM_WORLD,"ERROR1110: Excessive frequency count > %ld.\n",LIMIT);
                return true;
             }
 
-            planPoint->set_frequency(frequency);
+            planPoint->set_frequency(inputFrequencyPlans[i].frequency);
 
             if (strcmp(refinement_frequency,"plan") == 0 &&
                 inputFrequencyPlans[i].refine == 1) {
@@ -193,20 +593,32 @@ bool FrequencyPlan::assemble(char *refinement_frequency, unsigned long int input
 
             planPoint->set_simulated(false);
             planPoint->set_active(true);
+      } else if (inputFrequencyPlans[i].type == 3) {
 
-            frequency*=factor;
+         if (inputFrequencyPlans[i].seedPoints < 3) {
+            prefix(); PetscPrintf(PETSC_COMM_WORLD,"ERROR1129: Adaptive frequency plan at line %d requires at least 3 seed points.\n",
+                                  inputFrequencyPlans[i].lineNumber);
+            return true;
          }
-      } else if (inputFrequencyPlans[i].type == 2) {
+
+         int adaptiveIndex=adaptivePlanList.size();
+         adaptivePlanList.push_back(inputFrequencyPlans[i]);
+
+         int k=0;
+         while (k < inputFrequencyPlans[i].seedPoints) {
 
             FrequencyPlanPoint *planPoint=new FrequencyPlanPoint;
             planList.push_back(planPoint);
 
-            if (planList.size() > LIMIT) {
-               prefix(); PetscPrintf(PETSC_COMM_WORLD,"ERROR1110: Excessive frequency count > %ld.\n",LIMIT);
+            count++;
+            if (count > LIMIT) {
+               prefix(); PetscPrintf(PETSC_COMM_WORLD,"ERROR1130: Excessive frequency count > %ld.\n",LIMIT);
                return true;
             }
 
-            planPoint->set_frequency(inputFrequencyPlans[i].frequency);
+            double frequency=inputFrequencyPlans[i].start+k*(inputFrequencyPlans[i].stop-inputFrequencyPlans[i].start)/(inputFrequencyPlans[i].seedPoints-1);
+            planPoint->set_frequency(frequency);
+            planPoint->set_adaptiveIndex(adaptiveIndex);
 
             if (strcmp(refinement_frequency,"plan") == 0 &&
                 inputFrequencyPlans[i].refine == 1) {
@@ -221,13 +633,49 @@ bool FrequencyPlan::assemble(char *refinement_frequency, unsigned long int input
 
             planPoint->set_simulated(false);
             planPoint->set_active(true);
+
+            k++;
+         }
       }
 
       i++;
    }
 
+   // Of two overlapping segments, the smaller is materialized.  Its points are merged with the other
+   // materialized points by the sorts in eliminateDuplicates and sort, and with the larger segment
+   // by build_runs, so the merge is O(n log n) in the materialized points.
+   std::sort(segmentList.begin(),segmentList.end(),[](FrequencySegment p,FrequencySegment q) {return p.get_frequency(0) < q.get_frequency(0);});
+   vector<FrequencySegment> keepList;
+   i=0;
+   while (i < segmentList.size()) {
+      FrequencySegment segment=segmentList[i];
+      if (segment.size() > 0 && keepList.size() > 0 &&
+          segment.get_frequency(0) < keepList.back().get_frequency(keepList.back().size()-1)*(1-1e-14)) {
+         if (segment.size() > keepList.back().size()) {
+            FrequencySegment temp=keepList.back();
+            keepList.back()=segment;
+            segment=temp;
+         }
+         long unsigned int k=0;
+         while (k < segment.size()) {
+            FrequencyPlanPoint *planPoint=new FrequencyPlanPoint;
+            planList.push_back(planPoint);
+            planPoint->set_frequency(segment.get_frequency(k));
+            planPoint->set_refinementPriority(0);
+            planPoint->set_restart(true);
+            planPoint->set_simulated(false);
+            planPoint->set_active(true);
+            planPoint->set_meshSize(0);
+            k++;
+         }
+      } else if (segment.size() > 0) keepList.push_back(segment);
+      i++;
+   }
+   segmentList=keepList;
+
    eliminateDuplicates();
    sort();
+   build_runs();
 
    // set remaining cases ("plan" and "none" are taken care of above)
 
@@ -238,7 +686,7 @@ bool FrequencyPlan::assemble(char *refinement_frequency, unsigned long int input
 
    if (strcmp(refinement_frequency,"lowhigh") == 0) {
       setLowRefinementPriority(refinementPriority++);
-      if (planList.size() > 1) setHighRefinementPriority(refinementPriority++);
+      if (planSize > 1) setHighRefinementPriority(refinementPriority++);
    }
 
    if (strcmp(refinement_frequency,"high") == 0) 
@@ -246,90 +694,449 @@ bool FrequencyPlan::assemble(char *refinement_frequency, unsigned long int input
 
    if (strcmp(refinement_frequency,"highlow") == 0) {
       setHighRefinementPriority(refinementPriority++);
-      if (planList.size() > 1) setLowRefinementPriority(refinementPriority++);
+      if (planSize > 1) setLowRefinementPriority(refinementPriority++);
    }
 
+   if (strcmp(refinement_frequency,"all") == 0) nextRefinementPriority=planList.size()+1;
+   else nextRefinementPriority=refinementPriority;
+
+   scheduler.build(this,refinement_frequency);
+
    return false;
 }
 
 bool FrequencyPlan::is_refining ()
 {
-   long unsigned int i=0;
-   while (i < planList.size()) {
-      if (planList[i]->get_active() && planList[i]->get_refinementPriority() > 0) return true;
-      i++;
-   }
-   return false;
+   return scheduler.is_refining();
 }
 
-// get the next refinement case, if any
+// for callers that track the mesh by size only
 FrequencyPlanPoint* FrequencyPlan::get_frequency (char *refinement_frequency, double *frequency, bool *refine, bool *restart, int *meshSize)
 {
+   unsigned long long meshHash=0;
+   return get_frequency(refinement_frequency,frequency,refine,restart,meshSize,&meshHash);
+}
+
+// for callers without a mesh cache
+FrequencyPlanPoint* FrequencyPlan::get_frequency (char *refinement_frequency, double *frequency, bool *refine, bool *restart, int *meshSize, unsigned long long *meshHash)
+{
+   bool restartFromCache;
+   double cacheFrequency;
+   return get_frequency(refinement_frequency,frequency,refine,restart,meshSize,meshHash,&restartFromCache,&cacheFrequency);
+}
+
+// get the next refinement case, if any
+// refinement_frequency is resolved at assemble time and is retained here for the interface
+// meshSize and meshHash describe the current mesh for deciding which refined points must re-run
+// With a mesh cache set, a refining point that restarts is given restartFromCache=true when the cache
+// holds a mesh refined at or below the frequency, and the caller gets that mesh from
+// MeshCache::lookup at cacheFrequency instead of starting from the initial mesh.
+FrequencyPlanPoint* FrequencyPlan::get_frequency (char *refinement_frequency, double *frequency, bool *refine, bool *restart, int *meshSize, unsigned long long *meshHash,
+                                                  bool *restartFromCache, double *cacheFrequency)
+{
+   *restartFromCache=false;
+   *cacheFrequency=0;
+
    if (! hasRefined) {
 
       // get the next frequency that is refining with the lowest priority
 
-      long unsigned int refinementIndex=0;
-      int refinementPriority=INT_MAX;
-      bool foundRefinement=false;
-      long unsigned int i=0;
-      while (i < planList.size()) {
-         if (planList[i]->get_active() && !planList[i]->get_simulated() && planList[i]->get_refinementPriority() > 0) {
-            foundRefinement=true;
-            if (refinementPriority == INT_MAX) {
-               refinementPriority=planList[i]->get_refinementPriority();
-               refinementIndex=i;
-            } else {
-               if (planList[i]->get_refinementPriority() < refinementPriority) {
-                  refinementPriority=planList[i]->get_refinementPriority();
-                  refinementIndex=i;
-               }
-            }
-         }
-         i++;
-      }
-
-      if (foundRefinement) {
-         planList[refinementIndex]->set_simulated(true);
-         *frequency=planList[refinementIndex]->get_frequency();
+      FrequencyPlanPoint *planPoint=scheduler.next_refinement();
+      if (planPoint) {
+         planPoint->set_simulated(true);
+         *frequency=planPoint->get_frequency();
          *refine=true;
-         *restart=planList[refinementIndex]->get_restart();
+         *restart=planPoint->get_restart();
          refinedCount++;
-         return planList[refinementIndex];
+
+         // a finer mesh cannot be refined further toward this frequency, so only a coarser one is used
+         if (*restart && meshCache) {
+            bool needsCoarsening;
+            if (meshCache->find(*frequency,cacheFrequency,&needsCoarsening) && !needsCoarsening) *restartFromCache=true;
+            else *cacheFrequency=0;
+         }
+
+         return planPoint;
       }
    }
 
    // finished for case all
-   if (strcmp(refinement_frequency,"all") == 0) return nullptr;
+   if (scheduler.get_refineAll()) return nullptr;
 
    // refinement is over
 
-   // re-run frequencies if the mesh size has changed
+   // re-run frequencies if the mesh has changed
    if (!hasRefined && refinedCount > 1) {
-      long unsigned int i=0;
-      while (i < planList.size()) {
-         if (planList[i]->get_active() && planList[i]->get_meshSize() != *meshSize) planList[i]->set_simulated(false);
-         i++;
-      }
+      scheduler.invalidate(*meshSize,*meshHash);
+      prune_solved();
    }
 
    // always true for case "none"
    hasRefined=true;
 
+   // stop when one more solve is not expected to fit in the time budget
+   // the time between hand-outs during the sweep estimates the cost of a solve
+   // rank 0 decides from its clock so that all ranks stop at the same point; collective on PETSC_COMM_WORLD
+   if (hasTimeBudget && !budgetReached) {
+      chrono::system_clock::time_point now=chrono::system_clock::now();
+      if (hasSweepTime) {
+         sweepTime+=elapsed_time(lastSweepTime,now);
+         sweepCount++;
+      }
+      hasSweepTime=true;
+      lastSweepTime=now;
+
+      int stop=0;
+      if (sweepCount > 0 && timeBudget-elapsed_time(budgetStart,now) < sweepTime/sweepCount) stop=1;
+      MPI_Bcast(&stop,1,MPI_INT,0,PETSC_COMM_WORLD);
+
+      if (stop) {
+         prefix(); PetscPrintf(PETSC_COMM_WORLD,"Time budget of %g s reached with an estimated %g s per frequency.\n",timeBudget,sweepTime/max(sweepCount,1));
+         budgetReached=true;
+      }
+   }
+   if (budgetReached) return nullptr;
+
    // get the next available frequency
+   FrequencyPlanPoint *planPoint=scheduler.next_sweep();
+   if (planPoint) {
+      *frequency=planPoint->get_frequency();
+      *refine=false;
+      *restart=false;
+      planPoint->set_simulated(true);
+      return planPoint;
+   }
+
+   return nullptr;
+}
+
+// true while get_frequency still has refinement cases to hand out
+bool FrequencyPlan::refinement_pending ()
+{
+   if (hasRefined) return false;
+   return scheduler.refinement_pending();
+}
+
+// end refinement and collect all of the remaining sweep points in frequency order for distribution
+// the points are not marked as simulated
+void FrequencyPlan::get_sweep (vector<FrequencyPlanPoint *> *sweepList, int *meshSize, unsigned long long *meshHash)
+{
+   sweepList->clear();
+
+   if (scheduler.get_refineAll()) return;
+
+   if (!hasRefined && refinedCount > 1) {
+      scheduler.invalidate(*meshSize,*meshHash);
+      prune_solved();
+   }
+   hasRefined=true;
+
+   FrequencyPlanPoint *planPoint=scheduler.next_sweep();
+   while (planPoint) {
+      sweepList->push_back(planPoint);
+      planPoint=scheduler.next_sweep();
+   }
+}
+
+// Estimated error of the interpolated response at the midpoint of the interval from
+// solvedList[i] to solvedList[i+1], taken as the difference between a local cubic through the
+// nearest 4 solved points and the quadratic that drops the point farthest from the midpoint.
+// Relative to scale.
+double FrequencyPlan::adaptiveError (long unsigned int i, vector<FrequencyPlanPoint *> *solvedList, double scale)
+{
+   long unsigned int n=solvedList->size();
+   long unsigned int count=4;
+   if (n < count) count=n;
+
+   long int first=(long int)i-1;
+   if (first < 0) first=0;
+   if (first > (long int)(n-count)) first=n-count;
+
+   double f1=(*solvedList)[i]->get_frequency();
+   double f2=(*solvedList)[i+1]->get_frequency();
+   double midpoint=0.5*(f1+f2);
+   double width=f2-f1;
+
+   // the point farthest from the midpoint sits at one end of the stencil
+   long unsigned int drop=first;
+   if (abs((*solvedList)[first+count-1]->get_frequency()-midpoint) > abs((*solvedList)[first]->get_frequency()-midpoint)) drop=first+count-1;
+
+   // Lagrange weights on a normalized axis for conditioning
+   vector<double> weightHigh(count),weightLow(count);
+   long unsigned int j=0;
+   while (j < count) {
+      double xj=((*solvedList)[first+j]->get_frequency()-midpoint)/width;
+      weightHigh[j]=1;
+      weightLow[j]=1;
+      long unsigned int k=0;
+      while (k < count) {
+         if (k != j) {
+            double xk=((*solvedList)[first+k]->get_frequency()-midpoint)/width;
+            weightHigh[j]*=-xk/(xj-xk);
+            if (first+k != drop) weightLow[j]*=-xk/(xj-xk);
+         }
+         k++;
+      }
+      if (first+j == drop) weightLow[j]=0;
+      j++;
+   }
+
+   double error=0;
+   long unsigned int m=0;
+   while (m < (*solvedList)[i]->get_response()->size()) {
+      complex<double> high=0;
+      complex<double> low=0;
+      j=0;
+      while (j < count) {
+         complex<double> value=(*((*solvedList)[first+j]->get_response()))[m];
+         high+=weightHigh[j]*value;
+         low+=weightLow[j]*value;
+         j++;
+      }
+      if (abs(high-low) > error) error=abs(high-low);
+      m++;
+   }
+
+   return error/scale;
+}
+
+// Add points to the adaptive plans where the interpolated response is least accurate.
+// Call after the sweep completes with responses attached to the solved points by set_response,
+// and with the same responses on all ranks.
+// Returns true if points were added, in which case get_frequency hands out the new points.
+bool FrequencyPlan::adapt ()
+{
+   bool added=false;
+
+   // solved points are always materialized
+   vector<pair<long unsigned int,FrequencyPlanPoint *>> pointList;
+   get_materialized(&pointList);
+
+   // sorted midpoints added by all plans, since plans with overlapping bands see the same solved intervals
+   vector<double> midpointList;
+
+   long unsigned int a=0;
+   while (a < adaptivePlanList.size()) {
+      double start=adaptivePlanList[a].start;
+      double stop=adaptivePlanList[a].stop;
+
+      // solved points in the band, including those from other plans, with a consistent response size
+      vector<FrequencyPlanPoint *> solvedList;
+      long unsigned int responseSize=0;
+      int planCount=0;
+      double scale=0;
+      long unsigned int i=0;
+      while (i < pointList.size()) {
+         FrequencyPlanPoint *planPoint=pointList[i].second;
+         if (planPoint->get_active()) {
+            if (planPoint->get_adaptiveIndex() == (int)a) planCount++;
+            double frequency=planPoint->get_frequency();
+            if (planPoint->get_simulated() && frequency >= start*(1-1e-12) && frequency <= stop*(1+1e-12) &&
+                planPoint->get_response()->size() > 0) {
+               if (responseSize == 0) responseSize=planPoint->get_response()->size();
+               if (planPoint->get_response()->size() == responseSize) {
+                  solvedList.push_back(planPoint);
+                  long unsigned int m=0;
+                  while (m < responseSize) {
+                     if (abs((*(planPoint->get_response()))[m]) > scale) scale=abs((*(planPoint->get_response()))[m]);
+                     m++;
+                  }
+               }
+            }
+         }
+         i++;
+      }
+
+      if (solvedList.size() < 3 || scale == 0) {a++; continue;}
+
+      // rank the intervals by estimated error
+      vector<pair<double,long unsigned int>> errorList;
+      double maxError=0;
+      i=0;
+      while (i < solvedList.size()-1) {
+         double error=adaptiveError(i,&solvedList,scale);
+         if (error > maxError) maxError=error;
+         double f1=solvedList[i]->get_frequency();
+         double f2=solvedList[i+1]->get_frequency();
+         if (error > adaptivePlanList[a].tolerance && (f2-f1)/f2 > 1e-9) errorList.push_back(make_pair(error,i));
+         i++;
+      }
+      std::sort(errorList.begin(),errorList.end(),greater<pair<double,long unsigned int>>());
+
+      prefix(); PetscPrintf(PETSC_COMM_WORLD,"   adaptive frequency plan at line %d: %d points, estimated error %g\n",
+                            adaptivePlanList[a].lineNumber,planCount,maxError);
+
+      // bisect the worst intervals within the budget
+      vector<FrequencyPlanPoint *> newList;
+      i=0;
+      while (i < errorList.size() && planCount < adaptivePlanList[a].maxPoints) {
+         long unsigned int j=errorList[i].second;
+         double midpoint=0.5*(solvedList[j]->get_frequency()+solvedList[j+1]->get_frequency());
+
+         // skip an interval already bisected by an earlier plan
+         vector<double>::iterator it=std::lower_bound(midpointList.begin(),midpointList.end(),midpoint);
+         if (it != midpointList.end() && *it == midpoint) {i++; continue;}
+         midpointList.insert(it,midpoint);
+
+         FrequencyPlanPoint *planPoint=new FrequencyPlanPoint;
+         planPoint->set_frequency(midpoint);
+         planPoint->set_adaptiveIndex(a);
+         if (scheduler.get_refineAll()) {
+            planPoint->set_refinementPriority(nextRefinementPriority++);
+         } else {
+            planPoint->set_refinementPriority(0);
+         }
+         planPoint->set_restart(true);
+         planPoint->set_simulated(false);
+         planPoint->set_active(true);
+         planPoint->set_meshSize(0);
+         newList.push_back(planPoint);
+         planCount++;
+         i++;
+      }
+
+      // merge into the sorted plan
+      if (newList.size() > 0) {
+         i=0;
+         while (i < newList.size()) {
+            planList.push_back(newList[i]);
+            insert_point(newList[i]);
+            i++;
+         }
+         added=true;
+      }
+
+      a++;
+   }
+
+   if (added) {
+      index_runs();
+      scheduler.rebuild();
+   }
+
+   return added;
+}
+
+// Restore the completed points recorded by a previous run, in the order recorded.
+// A later record for the same frequency replaces an earlier one.
+// If the sweep had started, points refined on a mesh other than the final one are re-run.
+// Returns the number of records that do not match a point in the plan.
+int FrequencyPlan::restore (vector<double> *frequencies, vector<bool> *refined, vector<int> *meshSizes, vector<unsigned long long> *meshHashes)
+{
+   int unmatched=0;
+   bool sweeping=false;
    long unsigned int i=0;
-   while (i < planList.size()) {
-      if (planList[i]->get_active() && !planList[i]->get_simulated()) {
-         *frequency=planList[i]->get_frequency();
-         *refine=false;
-         *restart=false;
-         planList[i]->set_simulated(true);
-         return planList[i];
+   while (i < frequencies->size()) {
+      double frequency=(*frequencies)[i];
+
+      long unsigned int index;
+      if (find_index(frequency,1e-12,&index)) {
+         FrequencyPlanPoint *planPoint=get_point(index);
+         planPoint->set_simulated(true);
+         planPoint->set_meshSize((*meshSizes)[i]);
+         planPoint->set_meshHash((*meshHashes)[i]);
+         if ((*refined)[i]) refinedCount++;
+         else sweeping=true;
+      } else {
+         unmatched++;
       }
       i++;
    }
 
-   return nullptr;
+   vector<pair<long unsigned int,FrequencyPlanPoint *>> pointList;
+   get_materialized(&pointList);
+
+   if (sweeping && !scheduler.get_refineAll()) {
+      hasRefined=true;
+      int meshSize=meshSizes->back();
+      unsigned long long meshHash=meshHashes->back();
+      i=0;
+      while (i < pointList.size()) {
+         if (pointList[i].second->get_simulated() && pointList[i].second->is_stale(meshSize,meshHash)) pointList[i].second->set_simulated(false);
+         i++;
+      }
+   }
+
+   solvedList.clear();
+   i=0;
+   while (i < pointList.size()) {
+      if (pointList[i].second->get_simulated()) solvedList[pointList[i].second->get_frequency()]=pointList[i].second;
+      i++;
+   }
+
+   scheduler.rebuild();
+
+   return unmatched;
+}
+
+// "index", "outward", or "bisection", applied when the sweep starts
+bool FrequencyPlan::set_ordering (string ordering)
+{
+   if (ordering.compare("index") == 0) scheduler.set_ordering(ORDER_INDEX);
+   else if (ordering.compare("outward") == 0) scheduler.set_ordering(ORDER_OUTWARD);
+   else if (ordering.compare("bisection") == 0) scheduler.set_ordering(ORDER_BISECTION);
+   else {
+      prefix(); PetscPrintf(PETSC_COMM_WORLD,"ERROR1139: Frequency plan ordering \"%s\" is not supported.\n",ordering.c_str());
+      return true;
+   }
+   return false;
+}
+
+// stop handing out sweep points once the remaining time from start is below the expected cost of a solve
+void FrequencyPlan::set_time_budget (chrono::system_clock::time_point start, double budget)
+{
+   hasTimeBudget=true;
+   budgetStart=start;
+   timeBudget=budget;
+   budgetReached=false;
+}
+
+// call when the solution at the point is available to seed other points
+void FrequencyPlan::set_solved (FrequencyPlanPoint *planPoint)
+{
+   solvedList[planPoint->get_frequency()]=planPoint;
+}
+
+// remove solved points that are scheduled to re-run on a new mesh
+void FrequencyPlan::prune_solved ()
+{
+   map<double,FrequencyPlanPoint *>::iterator it=solvedList.begin();
+   while (it != solvedList.end()) {
+      if (!it->second->get_simulated()) it=solvedList.erase(it);
+      else it++;
+   }
+}
+
+// closest solved point in frequency for an initial guess, or nullptr if none
+FrequencyPlanPoint* FrequencyPlan::get_nearest_solved (double frequency)
+{
+   if (solvedList.size() == 0) return nullptr;
+
+   map<double,FrequencyPlanPoint *>::iterator high=solvedList.lower_bound(frequency);
+   if (high == solvedList.begin()) return high->second;
+   map<double,FrequencyPlanPoint *>::iterator low=high;
+   low--;
+   if (high == solvedList.end()) return low->second;
+   if (frequency-low->first <= high->first-frequency) return low->second;
+   return high->second;
+}
+
+// solved points with an attached response in frequency order
+void FrequencyPlan::get_responses (vector<FrequencyPlanPoint *> *responseList)
+{
+   responseList->clear();
+
+   vector<pair<long unsigned int,FrequencyPlanPoint *>> pointList;
+   get_materialized(&pointList);
+
+   long unsigned int i=0;
+   while (i < pointList.size()) {
+      FrequencyPlanPoint *planPoint=pointList[i].second;
+      if (planPoint->get_active() && planPoint->get_simulated() && planPoint->get_response()->size() > 0) {
+         responseList->push_back(planPoint);
+      }
+      i++;
+   }
 }
 
 void FrequencyPlan::print () {
@@ -338,8 +1145,10 @@ void FrequencyPlan::print () {
    prefix(); PetscPrintf(PETSC_COMM_WORLD,"         frequency   refinement priority restart\n");
    prefix(); PetscPrintf(PETSC_COMM_WORLD,"   ---------------------------------------------\n");
    long unsigned int i=0;
-   while (i < planList.size()) {
-      planList[i]->print();
+   while (i < planSize) {
+      FrequencyPlanPoint *planPoint=find_point(i);
+      if (planPoint) planPoint->print();
+      else {prefix(); PetscPrintf(PETSC_COMM_WORLD,"   %15g\n",frequency_at(i));}
       i++;
    }
    prefix(); PetscPrintf(PETSC_COMM_WORLD,"   ---------------------------------------------\n");
@@ -347,6 +1156,12 @@ void FrequencyPlan::print () {
 
 FrequencyPlan::~FrequencyPlan()
 {
+   map<pair<long unsigned int,long unsigned int>,FrequencyPlanPoint *>::iterator it=generatedList.begin();
+   while (it != generatedList.end()) {
+      delete it->second;
+      it++;
+   }
+
    long unsigned int i=0;
    while (i < planList.size()) {
       delete planList[i];
@@ -27,6 +27,15 @@
 #include <sstream>
 #include <string>
 #include <vector>
+#include <complex>
+#include <queue>
+#include <utility>
+#include <functional>
+#include <algorithm>
+#include <iterator>
+#include <map>
+#include <chrono>
+#include <cmath>
 #include "inputFrequency.h"
 #include "prefix.h"
 
@@ -47,6 +56,9 @@ class FrequencyPlanPoint {
       bool simulated;                        // true: used for simulation
       bool active;
       int meshSize;                          // used to determine when a re-simulation is required
+      unsigned long long meshHash=0;         // content hash of the mesh, 0 if not known, from mesh_hash
+      int adaptiveIndex=-1;                  // adaptive plan that owns the point, -1 for none
+      vector<complex<double>> response;      // solved response for adaptive sampling, such as S-parameters
    public:
       void set_frequency (double frequency_) {frequency=frequency_;}
       void set_refinementPriority (int refinementPriority_) {refinementPriority=refinementPriority_;}
@@ -54,30 +66,150 @@ class FrequencyPlanPoint {
       void set_simulated (bool simulated_) {simulated=simulated_;}
       void set_active (bool active_) {active=active_;}
       void set_meshSize (int meshSize_) {meshSize=meshSize_;}
+      void set_meshHash (unsigned long long meshHash_) {meshHash=meshHash_;}
+      void set_adaptiveIndex (int adaptiveIndex_) {adaptiveIndex=adaptiveIndex_;}
+      void set_response (vector<complex<double>> *response_) {response=*response_;}
       double get_frequency () {return frequency;}
       int get_refinementPriority () {return refinementPriority;}
       bool get_restart () {return restart;}
       bool get_simulated () {return simulated;}
       bool get_active () {return active;}
       int get_meshSize () {return meshSize;}
+      unsigned long long get_meshHash () {return meshHash;}
+      bool is_stale (int, unsigned long long);
+      int get_adaptiveIndex () {return adaptiveIndex;}
+      vector<complex<double>>* get_response () {return &response;}
       void print ();
 };
 
+// linear or log plan held in closed form, with point k at start+k*step or start*10^(k/pointsPerDecade)
+// the last point is exactly stop when stop falls on the grid
+class FrequencySegment {
+   private:
+      int type;                              // 0 - linear, 1 - log
+      double start;
+      double stop;
+      double step;
+      int pointsPerDecade;
+      long unsigned int count;
+      double estimate (double);
+   public:
+      FrequencySegment (struct inputFrequencyPlan *);
+      long unsigned int size () {return count;}
+      double get_frequency (long unsigned int);
+      long unsigned int lower_bound (double);
+      long unsigned int upper_bound (double);
+};
+
+// consecutive plan entries, either a range of segment points or a single materialized point
+struct FrequencyRun {
+   long int segment;                         // index into the segment list, -1 for a point
+   long unsigned int first;                  // first segment point
+   long unsigned int count;
+   FrequencyPlanPoint *point;                // for segment -1
+   long unsigned int offset;                 // plan index of the first entry
+};
+
+class FrequencyPlan;
+class MeshCache;
+
+// indexes a sorted plan so that FrequencyPlan::get_frequency does not re-scan the plan on each call
+// refinement points are held in a priority queue keyed on (priority,index) so that ties go to the lowest index
+// the sweep phase walks a cursor through the plan in the selected order:
+//    index   - increasing frequency
+//    outward - increasing frequency from the last refinement point, then decreasing below it,
+//              so that each point has an adjacent solved point to start from
+//    bisection - end points, then midpoints, then quarter points and so on, so that a partial
+//                sweep covers the whole band at a coarser resolution
+// the order is generated from the cursor so that the sweep does not hold a list over the whole plan
+#define ORDER_INDEX 0
+#define ORDER_OUTWARD 1
+#define ORDER_BISECTION 2
+class FrequencyScheduler {
+   private:
+      FrequencyPlan *plan=nullptr;
+      priority_queue<pair<int,long unsigned int>,vector<pair<int,long unsigned int>>,greater<pair<int,long unsigned int>>> refinementQueue;
+      vector<long unsigned int> refinedList;  // points handed out for refinement, in order
+      long int anchor=-1;                     // last refinement point
+      int ordering=ORDER_INDEX;
+      long unsigned int cursor=0;             // position in the sweep order
+      int level=0;                            // bisection level, with 2^level intervals
+      long unsigned int interval=0;           // next interval in the bisection level
+      bool levelSplit=false;                  // an interval in the bisection level has a midpoint
+      bool refineAll=false;                   // refinement_frequency is "all"
+      bool refining=false;                    // at least one point is refining
+      void reset_sweep () {cursor=0; level=0; interval=0; levelSplit=false;}
+      bool next_index (long unsigned int *);
+   public:
+      void build (FrequencyPlan *, char *);
+      void rebuild ();
+      FrequencyPlanPoint* next_refinement ();
+      void invalidate (int, unsigned long long);
+      FrequencyPlanPoint* next_sweep ();
+      bool refinement_pending ();
+      void set_ordering (int ordering_) {ordering=ordering_; reset_sweep();}
+      bool get_refineAll () {return refineAll;}
+      bool is_refining () {return refining;}
+};
+
 class FrequencyPlan {
    private:
-      vector<FrequencyPlanPoint *> planList;
+      vector<FrequencyPlanPoint *> planList;       // materialized points from point and adaptive plans and refined segments
+      vector<FrequencySegment> segmentList;        // linear and log plans not materialized
+      vector<FrequencyRun> runList;                // the plan in frequency order
+      long unsigned int planSize=0;
+      map<pair<long unsigned int,long unsigned int>,FrequencyPlanPoint *> generatedList;  // materialized segment points by (segment,point)
+      FrequencyScheduler scheduler;
       int refinedCount;
       bool hasRefined;
+      int nextRefinementPriority;
+      vector<struct inputFrequencyPlan> adaptivePlanList;
+      map<double,FrequencyPlanPoint *> solvedList;  // completed points for nearest-neighbor lookups
+      bool hasTimeBudget=false;
+      chrono::system_clock::time_point budgetStart;
+      double timeBudget=0;                         // s
+      bool hasSweepTime=false;
+      chrono::system_clock::time_point lastSweepTime;
+      double sweepTime=0;                          // s, sum over the measured solves
+      int sweepCount=0;                            // measured solves
+      bool budgetReached=false;
+      MeshCache *meshCache=nullptr;                // refined meshes for restarts, not owned
+      void sort ();
+      void eliminateDuplicates ();
+      void build_runs ();
+      void index_runs ();
+      long unsigned int find_run (long unsigned int);
+      double run_frequency (long unsigned int, long unsigned int);
+      bool find_index (double, double, long unsigned int *);
+      void insert_point (FrequencyPlanPoint *);
+      double adaptiveError (long unsigned int, vector<FrequencyPlanPoint *> *, double);
+      void prune_solved ();
    public:
       ~FrequencyPlan ();
       bool assemble (char *, unsigned long int, struct inputFrequencyPlan *);
       FrequencyPlanPoint* get_frequency (char *, double *, bool *, bool *, int *);
+      FrequencyPlanPoint* get_frequency (char *, double *, bool *, bool *, int *, unsigned long long *);
+      FrequencyPlanPoint* get_frequency (char *, double *, bool *, bool *, int *, unsigned long long *, bool *, double *);
+      void set_meshCache (MeshCache *meshCache_) {meshCache=meshCache_;}
       bool is_refining ();
-      void sort ();
-      void eliminateDuplicates ();
+      bool refinement_pending ();
+      void get_sweep (vector<FrequencyPlanPoint *> *, int *, unsigned long long *);
+      bool adapt ();
+      void get_responses (vector<FrequencyPlanPoint *> *);
+      int restore (vector<double> *, vector<bool> *, vector<int> *, vector<unsigned long long> *);
+      bool set_ordering (string);
+      void set_time_budget (chrono::system_clock::time_point, double);
+      bool is_budgetReached () {return budgetReached;}
+      void set_solved (FrequencyPlanPoint *);
+      FrequencyPlanPoint* get_nearest_solved (double);
       void setAllRefineRestart ();
       void setLowRefinementPriority (int);
       void setHighRefinementPriority (int);
+      long unsigned int size () {return planSize;}
+      double frequency_at (long unsigned int);
+      FrequencyPlanPoint* find_point (long unsigned int);
+      FrequencyPlanPoint* get_point (long unsigned int);
+      void get_materialized (vector<pair<long unsigned int,FrequencyPlanPoint *>> *);
       void print ();
 };
 
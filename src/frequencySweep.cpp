@@ -0,0 +1,292 @@
+////////////////////////////////////////////////////////////////////////////////
+//                                                                            //
+//    OpenParEM2D - A fullwave 2D electromagnetic simulator.                  //
+//    Copyright (C) 2025 Brian Young                                          //
+//                                                                            //
+//    This program is free software: you can redistribute it and/or modify    //
+//    it under the terms of the GNU General Public License as published by    //
+//    the Free Software Foundation, either version 3 of the License, or       //
+//    (at your option) any later version.                                     //
+//                                                                            //
+//    This program is distributed in the hope that it will be useful,         //
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of          //
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the           //
+//    GNU General Public License for more details.                            //
+//                                                                            //
+//    You should have received a copy of the GNU General Public License       //
+//    along with this program.  If not, see <http://www.gnu.org/licenses/>.   //
+//                                                                            //
+////////////////////////////////////////////////////////////////////////////////
+
+#include "frequencySweep.hpp"
+
+// collective on PETSC_COMM_WORLD
+// all ranks must pass the same sweep list, such as from FrequencyPlan::get_sweep
+bool FrequencySweep::initialize (int groupCount_, vector<FrequencyPlanPoint *> *sweepList_)
+{
+   PetscMPIInt size,rank;
+   MPI_Comm_size(PETSC_COMM_WORLD,&size);
+   MPI_Comm_rank(PETSC_COMM_WORLD,&rank);
+
+   if (groupCount_ < 1 || groupCount_ > size) {
+      prefix(); PetscPrintf(PETSC_COMM_WORLD,"ERROR1127: Sweep group count of %d must be from 1 to the number of ranks, %d.\n",groupCount_,size);
+      return true;
+   }
+
+   groupCount=groupCount_;
+   sweepList=*sweepList_;
+
+   indexList.clear();
+   long unsigned int i=0;
+   while (i < sweepList.size()) {
+      indexList[sweepList[i]]=i;
+      i++;
+   }
+
+   // groups are contiguous blocks of ranks
+   group=(int)(((long int)rank*groupCount)/size);
+   MPI_Comm_split(PETSC_COMM_WORLD,group,rank,&groupComm);
+
+   PetscMPIInt groupRank;
+   MPI_Comm_rank(groupComm,&groupRank);
+   isLeader=false;
+   if (groupRank == 0) isLeader=true;
+
+   // status table on world rank 0
+   MPI_Aint windowSize=0;
+   if (rank == 0) windowSize=(sweepList.size()+1)*sizeof(int);
+   MPI_Win_allocate(windowSize,sizeof(int),MPI_INFO_NULL,PETSC_COMM_WORLD,&windowData,&window);
+
+   if (rank == 0) {
+      MPI_Win_lock(MPI_LOCK_EXCLUSIVE,0,0,window);
+      i=0;
+      while (i < sweepList.size()+1) {
+         windowData[i]=SWEEP_PENDING;
+         i++;
+      }
+      MPI_Win_unlock(0,window);
+   }
+   MPI_Barrier(PETSC_COMM_WORLD);
+
+   claimedStatus.assign(sweepList.size(),SWEEP_PENDING);
+   resultList.clear();
+   initialized=true;
+
+   return false;
+}
+
+void FrequencySweep::set_status (long unsigned int index, int status)
+{
+   MPI_Win_lock(MPI_LOCK_SHARED,0,0,window);
+   MPI_Accumulate(&status,1,MPI_INT,0,(MPI_Aint)(index+1),1,MPI_INT,MPI_REPLACE,window);
+   MPI_Win_unlock(0,window);
+}
+
+// group leader only
+// returns the sweep index of the claimed point or -1 when no work remains
+long int FrequencySweep::claim ()
+{
+   long int count=sweepList.size();
+
+   // take the next point in frequency order
+   int one=1;
+   int ticket;
+   MPI_Win_lock(MPI_LOCK_SHARED,0,0,window);
+   MPI_Fetch_and_op(&one,&ticket,MPI_INT,0,0,MPI_SUM,window);
+   MPI_Win_unlock(0,window);
+
+   if (ticket < count) {
+      set_status(ticket,SWEEP_CLAIMED);
+      claimedStatus[ticket]=SWEEP_CLAIMED;
+      return ticket;
+   }
+
+   // steal re-queued points, waiting on points still in progress elsewhere since they may yet fail
+   // the counter is read with the table since a point whose ticket is taken stays pending until
+   // its group publishes the claim
+   vector<int> table(count+1);
+   while (true) {
+      MPI_Win_lock(MPI_LOCK_SHARED,0,0,window);
+      MPI_Get_accumulate(nullptr,0,MPI_INT,table.data(),(int)count+1,MPI_INT,0,0,(int)count+1,MPI_INT,MPI_NO_OP,window);
+      MPI_Win_unlock(0,window);
+
+      long int counter=table[0];
+      int *status=table.data()+1;
+
+      bool inProgress=false;
+      long int i=0;
+      while (i < count) {
+         if (status[i] == SWEEP_PENDING && i < counter) inProgress=true;
+         if (status[i] == SWEEP_REQUEUED) {
+            int reclaimed=SWEEP_RECLAIMED;
+            int requeued=SWEEP_REQUEUED;
+            int previous;
+            MPI_Win_lock(MPI_LOCK_SHARED,0,0,window);
+            MPI_Compare_and_swap(&reclaimed,&requeued,&previous,MPI_INT,0,(MPI_Aint)(i+1),window);
+            MPI_Win_unlock(0,window);
+            if (previous == SWEEP_REQUEUED) {
+               claimedStatus[i]=SWEEP_RECLAIMED;
+               return i;
+            }
+         }
+         if (status[i] == SWEEP_CLAIMED || status[i] == SWEEP_RECLAIMED) inProgress=true;
+         i++;
+      }
+
+      if (!inProgress) break;
+      usleep(pollInterval);
+   }
+
+   return -1;
+}
+
+// collective on the group
+FrequencyPlanPoint* FrequencySweep::next ()
+{
+   if (!initialized) return nullptr;
+
+   long int index=-1;
+   if (isLeader) index=claim();
+   MPI_Bcast(&index,1,MPI_LONG,0,groupComm);
+
+   if (index < 0) return nullptr;
+
+   sweepList[index]->set_simulated(true);
+   return sweepList[index];
+}
+
+bool FrequencySweep::find_index (FrequencyPlanPoint *planPoint, long unsigned int *index)
+{
+   map<FrequencyPlanPoint *,long unsigned int>::iterator it=indexList.find(planPoint);
+   if (it == indexList.end()) {
+      prefix(); PetscPrintf(PETSC_COMM_SELF,"ERROR1152: Frequency %g is not in the sweep.\n",planPoint->get_frequency());
+      return true;
+   }
+   *index=it->second;
+   return false;
+}
+
+// collective on the group
+// the result is kept on the group leader
+bool FrequencySweep::complete (FrequencyPlanPoint *planPoint, vector<double> *result)
+{
+   if (!isLeader) return false;
+
+   long unsigned int index;
+   if (find_index(planPoint,&index)) return true;
+
+   resultList[index]=*result;
+   set_status(index,SWEEP_DONE);
+   return false;
+}
+
+// collective on the group
+// the first failure re-queues the point for another group, and the second is final
+bool FrequencySweep::fail (FrequencyPlanPoint *planPoint)
+{
+   planPoint->set_simulated(false);
+
+   if (!isLeader) return false;
+
+   long unsigned int index;
+   if (find_index(planPoint,&index)) return true;
+
+   if (claimedStatus[index] == SWEEP_CLAIMED) set_status(index,SWEEP_REQUEUED);
+   else set_status(index,SWEEP_FAILED);
+   return false;
+}
+
+// collective on PETSC_COMM_WORLD
+// gathers the results on world rank 0 in sweep order and syncs the simulated flags on all ranks
+// returns true if any point failed
+bool FrequencySweep::collect (vector<vector<double>> *results)
+{
+   PetscMPIInt size,rank;
+   MPI_Comm_size(PETSC_COMM_WORLD,&size);
+   MPI_Comm_rank(PETSC_COMM_WORLD,&rank);
+
+   results->clear();
+   if (!initialized) return false;
+
+   int count=sweepList.size();
+
+   vector<int> status(count);
+   if (rank == 0) {
+      MPI_Win_lock(MPI_LOCK_SHARED,0,0,window);
+      long int i=0;
+      while (i < count) {
+         status[i]=windowData[i+1];
+         i++;
+      }
+      MPI_Win_unlock(0,window);
+   }
+   MPI_Bcast(status.data(),count,MPI_INT,0,PETSC_COMM_WORLD);
+
+   bool fail=false;
+   long int i=0;
+   while (i < count) {
+      if (status[i] == SWEEP_DONE) sweepList[i]->set_simulated(true);
+      else {
+         sweepList[i]->set_simulated(false);
+         prefix(); PetscPrintf(PETSC_COMM_WORLD,"ERROR1128: Frequency %g failed to solve in the sweep groups.\n",sweepList[i]->get_frequency());
+         fail=true;
+      }
+      i++;
+   }
+
+   if (rank == 0) {
+      results->resize(count);
+
+      map<long unsigned int,vector<double>>::iterator it=resultList.begin();
+      while (it != resultList.end()) {
+         (*results)[it->first]=it->second;
+         it++;
+      }
+
+      int j=1;
+      while (j < size) {
+         int resultCount;
+         MPI_Recv(&resultCount,1,MPI_INT,j,200,PETSC_COMM_WORLD,MPI_STATUS_IGNORE);
+         int k=0;
+         while (k < resultCount) {
+            long int index;
+            int length;
+            MPI_Recv(&index,1,MPI_LONG,j,201,PETSC_COMM_WORLD,MPI_STATUS_IGNORE);
+            MPI_Recv(&length,1,MPI_INT,j,202,PETSC_COMM_WORLD,MPI_STATUS_IGNORE);
+            (*results)[index].resize(length);
+            MPI_Recv((*results)[index].data(),length,MPI_DOUBLE,j,203,PETSC_COMM_WORLD,MPI_STATUS_IGNORE);
+            k++;
+         }
+         j++;
+      }
+   } else {
+      int resultCount=0;
+      if (isLeader) resultCount=resultList.size();
+      MPI_Send(&resultCount,1,MPI_INT,0,200,PETSC_COMM_WORLD);
+      if (isLeader) {
+         map<long unsigned int,vector<double>>::iterator it=resultList.begin();
+         while (it != resultList.end()) {
+            long int index=it->first;
+            int length=it->second.size();
+            MPI_Send(&index,1,MPI_LONG,0,201,PETSC_COMM_WORLD);
+            MPI_Send(&length,1,MPI_INT,0,202,PETSC_COMM_WORLD);
+            MPI_Send(it->second.data(),length,MPI_DOUBLE,0,203,PETSC_COMM_WORLD);
+            it++;
+         }
+      }
+   }
+
+   return fail;
+}
+
+// collective on PETSC_COMM_WORLD
+void FrequencySweep::finalize ()
+{
+   if (!initialized) return;
+   MPI_Win_free(&window);
+   windowData=nullptr;
+   MPI_Comm_free(&groupComm);
+   resultList.clear();
+   initialized=false;
+}
+
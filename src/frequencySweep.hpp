@@ -0,0 +1,93 @@
+////////////////////////////////////////////////////////////////////////////////
+//                                                                            //
+//    OpenParEM2D - A fullwave 2D electromagnetic simulator.                  //
+//    Copyright (C) 2025 Brian Young                                          //
+//                                                                            //
+//    This program is free software: you can redistribute it and/or modify    //
+//    it under the terms of the GNU General Public License as published by    //
+//    the Free Software Foundation, either version 3 of the License, or       //
+//    (at your option) any later version.                                     //
+//                                                                            //
+//    This program is distributed in the hope that it will be useful,         //
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of          //
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the           //
+//    GNU General Public License for more details.                            //
+//                                                                            //
+//    You should have received a copy of the GNU General Public License       //
+//    along with this program.  If not, see <http://www.gnu.org/licenses/>.   //
+//                                                                            //
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef FREQUENCYSWEEP_H
+#define FREQUENCYSWEEP_H
+
+#include "petscsys.h"
+#include <iostream>
+#include <string>
+#include <vector>
+#include <map>
+#include <unistd.h>
+#include "frequencyPlan.hpp"
+#include "prefix.h"
+
+using namespace std;
+
+extern "C" void prefix ();
+
+// Runs the post-refinement sweep of a FrequencyPlan in k groups of ranks split from PETSC_COMM_WORLD.
+//
+// Points are claimed dynamically from a status table held in an MPI window on world rank 0, so a
+// fast group keeps pulling points while a slow group is busy. A point that fails in one group is
+// re-queued for any group to pick up, and a second failure marks it as failed.
+// Results are kept on the group leaders until collect gathers them on world rank 0 in plan order.
+//
+// usage, with all ranks calling each method:
+//    plan.get_sweep(&sweepList,&meshSize,&meshHash);
+//    sweep.initialize(groupCount,&sweepList);
+//    while ((planPoint=sweep.next())) {
+//       solve on sweep.get_comm()
+//       if (failed) sweep.fail(planPoint); else sweep.complete(planPoint,&result);
+//    }
+//    sweep.collect(&results);
+//    sweep.finalize();
+
+// sweep status for each point
+#define SWEEP_PENDING 0
+#define SWEEP_CLAIMED 1
+#define SWEEP_DONE 2
+#define SWEEP_REQUEUED 3
+#define SWEEP_RECLAIMED 4
+#define SWEEP_FAILED 5
+
+class FrequencySweep {
+   private:
+      vector<FrequencyPlanPoint *> sweepList;  // in frequency order
+      map<FrequencyPlanPoint *,long unsigned int> indexList;
+      int groupCount=1;
+      int group=0;                             // this rank's group
+      MPI_Comm groupComm=MPI_COMM_NULL;
+      bool isLeader=false;                     // rank 0 of groupComm
+      MPI_Win window=MPI_WIN_NULL;             // [counter,status 0..n-1] on world rank 0
+      int *windowData=nullptr;
+      bool initialized=false;
+      vector<int> claimedStatus;               // status written when this group claimed the point
+      map<long unsigned int,vector<double>> resultList;  // completed on this group, by sweep index
+      useconds_t pollInterval=10000;           // wait while other groups finish points that may be re-queued
+      void set_status (long unsigned int, int);
+      long int claim ();
+      bool find_index (FrequencyPlanPoint *, long unsigned int *);
+   public:
+      bool initialize (int, vector<FrequencyPlanPoint *> *);
+      FrequencyPlanPoint* next ();
+      bool complete (FrequencyPlanPoint *, vector<double> *);
+      bool fail (FrequencyPlanPoint *);
+      bool collect (vector<vector<double>> *);
+      void finalize ();
+      MPI_Comm get_comm () {return groupComm;}
+      int get_group () {return group;}
+      int get_groupCount () {return groupCount;}
+      bool is_leader () {return isLeader;}
+};
+
+#endif
+
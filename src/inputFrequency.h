@@ -22,12 +22,15 @@
 #define INPUTFREQUENCY_H
 
 struct inputFrequencyPlan {
-   int type;                 // 0 => linear, 1 => log, 2 => point
+   int type;                 // 0 => linear, 1 => log, 2 => point, 3 => adaptive
    double frequency;         // for point
-   double start;             // for linear and log
-   double stop;              // for linear and log
+   double start;             // for linear, log, and adaptive
+   double stop;              // for linear, log, and adaptive
    double step;              // for linear
    int pointsPerDecade;      // for log
+   int seedPoints;           // for adaptive - linearly spaced starting points
+   int maxPoints;            // for adaptive - point budget including the seed points
+   double tolerance;         // for adaptive - relative error target for the interpolated response
    int refine;               // 0 => do not refine the mesh at the frequency point(s), 2 => refine the mesh
    int lineNumber;
 };
@@ -19,6 +19,7 @@
 ////////////////////////////////////////////////////////////////////////////////
 
 #include "jobrelated.hpp"
+#include "sweepJournal.hpp"
 
 void exit_job_on_error (chrono::system_clock::time_point job_start_time, const char *lockfile, bool removeLock)
 {
@@ -27,6 +28,9 @@ void exit_job_on_error (chrono::system_clock::time_point job_start_time, const c
 
    prefix(); PetscPrintf(PETSC_COMM_WORLD,"Job Complete\n");
 
+   // keep the completed frequencies for a restart
+   journal_flush();
+
    // remove the lock - not 100% safe
    if (rank == 0 && removeLock) {
       if (std::filesystem::exists(lockfile)) {
@@ -177,88 +177,88 @@ void point_print (struct point a)
 // keywordPair
 ///////////////////////////////////////////////////////////////////////////////////////////
 
-bool keywordPair::int_limit_checks (string *keyword, int lineNumber)
+bool keywordPair::int_limit_checks (string_view keyword, int lineNumber)
 {
-   if (positive_required && int_value <= 0) {
-      prefix(); PetscPrintf(PETSC_COMM_WORLD,"%s%sERROR1017: %s at line %d is required to be positive.\n",
-                                             indent.c_str(),indent.c_str(),keyword->c_str(),lineNumber);
+   if (get_positive_required() && int_value <= 0) {
+      prefix(); PetscPrintf(PETSC_COMM_WORLD,"%s%sERROR1017: %.*s at line %d is required to be positive.\n",
+                                             indent.c_str(),indent.c_str(),(int)keyword.size(),keyword.data(),lineNumber);
       return false;
    }
 
-   if (non_negative_required && int_value < 0) {
-      prefix(); PetscPrintf(PETSC_COMM_WORLD,"%s%sERROR1018: %s at line %d is required to be non-negative.\n",
-                                             indent.c_str(),indent.c_str(),keyword->c_str(),lineNumber);
+   if (get_non_negative_required() && int_value < 0) {
+      prefix(); PetscPrintf(PETSC_COMM_WORLD,"%s%sERROR1018: %.*s at line %d is required to be non-negative.\n",
+                                             indent.c_str(),indent.c_str(),(int)keyword.size(),keyword.data(),lineNumber);
       return false;
    }
 
-   if (int_value < lowerLimit) {
-      prefix(); PetscPrintf(PETSC_COMM_WORLD,"%s%sERROR1019: %s at line %d is required to be >= %g.\n",
-                                             indent.c_str(),indent.c_str(),keyword->c_str(),lineNumber,lowerLimit);
+   if (int_value < get_lowerLimit()) {
+      prefix(); PetscPrintf(PETSC_COMM_WORLD,"%s%sERROR1019: %.*s at line %d is required to be >= %g.\n",
+                                             indent.c_str(),indent.c_str(),(int)keyword.size(),keyword.data(),lineNumber,get_lowerLimit());
       return false;
    }
 
-   if (int_value > upperLimit) {
-      prefix(); PetscPrintf(PETSC_COMM_WORLD,"%s%sERROR1020: %s at line %d is required to be <= %g.\n",
-                                             indent.c_str(),indent.c_str(),keyword->c_str(),lineNumber,upperLimit);
+   if (int_value > get_upperLimit()) {
+      prefix(); PetscPrintf(PETSC_COMM_WORLD,"%s%sERROR1020: %.*s at line %d is required to be <= %g.\n",
+                                             indent.c_str(),indent.c_str(),(int)keyword.size(),keyword.data(),lineNumber,get_upperLimit());
       return false;
    }
 
    return true;
 }
 
-bool keywordPair::dbl_limit_checks (string *keyword, int lineNumber)
+bool keywordPair::dbl_limit_checks (string_view keyword, int lineNumber)
 {
-   if (positive_required && dbl_value <= 0) {
-      prefix(); PetscPrintf(PETSC_COMM_WORLD,"%s%sERROR1021: %s at line %d is required to be positive.\n",
-                                             indent.c_str(),indent.c_str(),keyword->c_str(),lineNumber);
+   if (get_positive_required() && dbl_value <= 0) {
+      prefix(); PetscPrintf(PETSC_COMM_WORLD,"%s%sERROR1021: %.*s at line %d is required to be positive.\n",
+                                             indent.c_str(),indent.c_str(),(int)keyword.size(),keyword.data(),lineNumber);
       return false; 
    }
 
-   if (non_negative_required && dbl_value < 0) {
-      prefix(); PetscPrintf(PETSC_COMM_WORLD,"%s%sERROR1022: %s at line %d is required to be non-negative.\n",
-                                             indent.c_str(),indent.c_str(),keyword->c_str(),lineNumber);
+   if (get_non_negative_required() && dbl_value < 0) {
+      prefix(); PetscPrintf(PETSC_COMM_WORLD,"%s%sERROR1022: %.*s at line %d is required to be non-negative.\n",
+                                             indent.c_str(),indent.c_str(),(int)keyword.size(),keyword.data(),lineNumber);
       return false;
    }
 
-   if (dbl_value < lowerLimit*(1-dbl_tolerance)) {
-      prefix(); PetscPrintf(PETSC_COMM_WORLD,"%s%sERROR1023: %s at line %d is required to be >= %g.\n",
-                                             indent.c_str(),indent.c_str(),keyword->c_str(),lineNumber,lowerLimit);
+   if (dbl_value < get_lowerLimit()*(1-dbl_tolerance)) {
+      prefix(); PetscPrintf(PETSC_COMM_WORLD,"%s%sERROR1023: %.*s at line %d is required to be >= %g.\n",
+                                             indent.c_str(),indent.c_str(),(int)keyword.size(),keyword.data(),lineNumber,get_lowerLimit());
       return false;
    }
 
-   if (dbl_value > upperLimit*(1+dbl_tolerance)) { 
-      prefix(); PetscPrintf(PETSC_COMM_WORLD,"%s%sERROR1024: %s at line %d is required to be <= %g.\n",
-                                             indent.c_str(),indent.c_str(),keyword->c_str(),lineNumber,upperLimit);
+   if (dbl_value > get_upperLimit()*(1+dbl_tolerance)) { 
+      prefix(); PetscPrintf(PETSC_COMM_WORLD,"%s%sERROR1024: %.*s at line %d is required to be <= %g.\n",
+                                             indent.c_str(),indent.c_str(),(int)keyword.size(),keyword.data(),lineNumber,get_upperLimit());
       return false;
    }
 
    return true;
 }
 
-bool keywordPair::point_limit_checks (string *keyword, int lineNumber)
+bool keywordPair::point_limit_checks (string_view keyword, int lineNumber)
 {
-   if (positive_required && (point_value.x <= 0 || point_value.y <= 0 || (point_value.dim == 3 && point_value.z <= 0))) {
-      prefix(); PetscPrintf(PETSC_COMM_WORLD,"%s%sERROR1025: %s at line %d is required to be positive.\n",
-                                             indent.c_str(),indent.c_str(),keyword->c_str(),lineNumber);
+   if (get_positive_required() && (point_value.x <= 0 || point_value.y <= 0 || (point_value.dim == 3 && point_value.z <= 0))) {
+      prefix(); PetscPrintf(PETSC_COMM_WORLD,"%s%sERROR1025: %.*s at line %d is required to be positive.\n",
+                                             indent.c_str(),indent.c_str(),(int)keyword.size(),keyword.data(),lineNumber);
       return false;
    }
 
-   if (non_negative_required && (point_value.x < 0 || point_value.y < 0 || (point_value.dim == 3 && point_value.z < 0))) {
-      prefix(); PetscPrintf(PETSC_COMM_WORLD,"%s%sERROR1026: %s at line %d is required to be non-negative.\n",
-                                             indent.c_str(),indent.c_str(),keyword->c_str(),lineNumber);
+   if (get_non_negative_required() && (point_value.x < 0 || point_value.y < 0 || (point_value.dim == 3 && point_value.z < 0))) {
+      prefix(); PetscPrintf(PETSC_COMM_WORLD,"%s%sERROR1026: %.*s at line %d is required to be non-negative.\n",
+                                             indent.c_str(),indent.c_str(),(int)keyword.size(),keyword.data(),lineNumber);
       return false;
    }
 
-   if (point_value.x < lowerLimit*(1-dbl_tolerance) || point_value.y < lowerLimit*(1-dbl_tolerance) || (point_value.dim == 3 && point_value.z < lowerLimit*(1-dbl_tolerance))) {
-      prefix(); PetscPrintf(PETSC_COMM_WORLD,"%s%sERROR1027: %s at line %d is required to be >= %g.\n",
-                                             indent.c_str(),indent.c_str(),keyword->c_str(),lineNumber,lowerLimit);
+   if (point_value.x < get_lowerLimit()*(1-dbl_tolerance) || point_value.y < get_lowerLimit()*(1-dbl_tolerance) || (point_value.dim == 3 && point_value.z < get_lowerLimit()*(1-dbl_tolerance))) {
+      prefix(); PetscPrintf(PETSC_COMM_WORLD,"%s%sERROR1027: %.*s at line %d is required to be >= %g.\n",
+                                             indent.c_str(),indent.c_str(),(int)keyword.size(),keyword.data(),lineNumber,get_lowerLimit());
 
       return false;
    }
 
-   if (point_value.x > upperLimit*(1+dbl_tolerance) || point_value.y > upperLimit*(1+dbl_tolerance) || (point_value.dim == 3 && point_value.z > upperLimit*(1+dbl_tolerance))) {
-      prefix(); PetscPrintf(PETSC_COMM_WORLD,"%s%sERROR1028: %s at line %d is required to be <= %g.\n",
-                                             indent.c_str(),indent.c_str(),keyword->c_str(),lineNumber,upperLimit);
+   if (point_value.x > get_upperLimit()*(1+dbl_tolerance) || point_value.y > get_upperLimit()*(1+dbl_tolerance) || (point_value.dim == 3 && point_value.z > get_upperLimit()*(1+dbl_tolerance))) {
+      prefix(); PetscPrintf(PETSC_COMM_WORLD,"%s%sERROR1028: %.*s at line %d is required to be <= %g.\n",
+                                             indent.c_str(),indent.c_str(),(int)keyword.size(),keyword.data(),lineNumber,get_upperLimit());
       return false;
    }
 
@@ -270,11 +270,11 @@ bool keywordPair::limit_check (string type)
    bool fail=false;
 
    if (type.compare("int") == 0) {
-      if (! int_limit_checks (&keyword, lineNumber)) fail=true;
+      if (! int_limit_checks (get_keyword(), lineNumber)) fail=true;
    } else if (type.compare("double") == 0) {
-      if (! dbl_limit_checks (&keyword, lineNumber)) fail=true;
+      if (! dbl_limit_checks (get_keyword(), lineNumber)) fail=true;
    } else if (type.compare("point") == 0) {
-      if (! point_limit_checks (&keyword, lineNumber)) fail=true;
+      if (! point_limit_checks (get_keyword(), lineNumber)) fail=true;
    } else {
       prefix(); PetscPrintf(PETSC_COMM_WORLD,"ASSERT: bad selection in keywordPair::limit_check\n");
    }
@@ -282,17 +282,143 @@ bool keywordPair::limit_check (string type)
    return fail;
 }
 
-bool keywordPair::match_alias (string *token)
+keywordPair::keywordPair (const keywordPair &a)
 {
-   long unsigned int i=0;
-   while (i < aliases.size()) {
-      if (aliases[i].compare(*token) == 0) return true;
-      i++;
+   *this=a;
+}
+
+keywordPair& keywordPair::operator= (const keywordPair &a)
+{
+   if (this == &a) return *this;
+
+   delete settings;
+   settings=nullptr;
+   if (a.settings) settings=new keywordSettings(*a.settings);
+
+   delete text;
+   text=nullptr;
+   if (a.text) text=new string(*a.text);
+
+   schema=a.schema;
+   lineNumber=a.lineNumber;
+   point_value=a.point_value;  // the largest member, so the whole value
+   alias=a.alias;
+   any=a.any;
+   loaded=a.loaded;
+   checkLimits=a.checkLimits;
+
+   return *this;
+}
+
+// settings for changes one at a time, starting from the schema if there is one
+keywordSettings* keywordPair::get_settings ()
+{
+   if (settings) return settings;
+
+   settings=new keywordSettings();
+   if (schema) {
+      int k=0;
+      while (k < KEYWORD_MAX_ALIASES && schema->aliases[k]) {
+         settings->aliases.push_back(schema->aliases[k]);
+         k++;
+      }
+      settings->lowerLimit=schema->lowerLimit;
+      settings->upperLimit=schema->upperLimit;
+      settings->positive_required=schema->positive_required;
+      settings->non_negative_required=schema->non_negative_required;
+   }
+   return settings;
+}
+
+// take the aliases, limits and requirements from a shared schema entry, which is read in place
+void keywordPair::set_schema (const keywordSchema *schema_, bool checkLimits_)
+{
+   schema=schema_;
+   delete settings;
+   settings=nullptr;
+   delete text;
+   text=nullptr;
+   point_value={};
+   alias=0;
+   any=false;
+   loaded=false;
+   checkLimits=checkLimits_;
+}
+
+bool keywordPair::match_alias (string_view token)
+{
+   if (settings) {
+      long unsigned int i=0;
+      while (i < settings->aliases.size()) {
+         if (token.compare(settings->aliases[i]) == 0) return true;
+         i++;
+      }
+      return false;
+   }
+
+   if (schema) {
+      int k=0;
+      while (k < KEYWORD_MAX_ALIASES && schema->aliases[k]) {
+         if (token.compare(schema->aliases[k]) == 0) return true;
+         k++;
+      }
    }
    return false;
 }
 
-bool keywordPair::loadBool (string *token, string *value_, int lineNumber_)
+// record which alias was used so that get_keyword returns the text from the input file
+void keywordPair::set_alias (string_view token)
+{
+   if (settings) {
+      long unsigned int i=0;
+      while (i < settings->aliases.size()) {
+         if (token.compare(settings->aliases[i]) == 0) {alias=i; return;}
+         i++;
+      }
+      return;
+   }
+
+   if (schema) {
+      int k=0;
+      while (k < KEYWORD_MAX_ALIASES && schema->aliases[k]) {
+         if (token.compare(schema->aliases[k]) == 0) {alias=k; return;}
+         k++;
+      }
+   }
+}
+
+string keywordPair::get_keyword () const
+{
+   if (settings) {
+      if (alias < settings->aliases.size()) return settings->aliases[alias];
+      return "";
+   }
+   if (schema && alias < KEYWORD_MAX_ALIASES && schema->aliases[alias]) return schema->aliases[alias];
+   return "";
+}
+
+// "any" is held as a flag, and other text is kept only for keywords that take text, such as a name
+void keywordPair::set_value (string_view a)
+{
+   any=false;
+   if (a.compare("any") == 0) {
+      any=true;
+      delete text;
+      text=nullptr;
+      return;
+   }
+   if (text) text->assign(a);
+   else text=new string(a);
+}
+
+string keywordPair::get_value () const
+{
+   if (any) return "any";
+   if (text) return *text;
+   return "";
+}
+
+bool keywordPair::loadBool (string_view token, string_view value_, int lineNumber_)
 {
    // check for duplicate
    if (loaded) {
@@ -302,26 +428,25 @@ bool keywordPair::loadBool (string *token, string *value_, int lineNumber_)
    }
 
    // check for a boolean
-   if (value_->compare("true") != 0 && value_->compare("false") != 0) {
-      prefix(); PetscPrintf(PETSC_COMM_WORLD,"%s%sERROR1030: %s value at line %d is invalid.\n",
-                                             indent.c_str(),indent.c_str(),token->c_str(),lineNumber_);
+   if (value_.compare("true") != 0 && value_.compare("false") != 0) {
+      prefix(); PetscPrintf(PETSC_COMM_WORLD,"%s%sERROR1030: %.*s value at line %d is invalid.\n",
+                                             indent.c_str(),indent.c_str(),(int)token.size(),token.data(),lineNumber_);
       return true;
    }
 
    // get the value
-   if (value_->compare("true") == 0) bool_value=true;
+   if (value_.compare("true") == 0) bool_value=true;
    else bool_value=false;
 
    // save it
-   keyword=*token;
-   value=*value_;
+   set_alias(token);
    lineNumber=lineNumber_;
    loaded=true;
 
    return false;
 }
 
-bool keywordPair::loadInt (string *token, string *value_, int lineNumber_)
+bool keywordPair::loadInt (string_view token, string_view value_, int lineNumber_)
 {
    // check for duplicate
    if (loaded) {
@@ -330,18 +455,17 @@ bool keywordPair::loadInt (string *token, string *value_, int lineNumber_)
       return true;
    }
 
-   // check for a pure number
-   if (!is_int(value_)) {
-      prefix(); PetscPrintf(PETSC_COMM_WORLD,"%s%sERROR1032: %s value at line %d is invalid.\n",
-                                             indent.c_str(),indent.c_str(),token->c_str(),lineNumber_);
+   // get the value
+   size_t position;
+   int result=parse_int(value_,&int_value,&position);
+   if (result == PARSE_INVALID) {
+      prefix(); PetscPrintf(PETSC_COMM_WORLD,"%s%sERROR1032: %.*s value \"%.*s\" at line %d is invalid at character %d.\n",
+                                             indent.c_str(),indent.c_str(),(int)token.size(),token.data(),(int)value_.size(),value_.data(),lineNumber_,(int)position+1);
       return true;
    }
-
-   // get the value
-   try {int_value=stoi(*value_);}
-   catch (const std::invalid_argument& ia) {
-      prefix(); PetscPrintf(PETSC_COMM_WORLD,"%s%sERROR1033: %s value at line %d is invalid.\n",
-                                             indent.c_str(),indent.c_str(),token->c_str(),lineNumber_);
+   if (result == PARSE_OUT_OF_RANGE) {
+      prefix(); PetscPrintf(PETSC_COMM_WORLD,"%s%sERROR1033: %.*s value \"%.*s\" at line %d is out of range at character %d.\n",
+                                             indent.c_str(),indent.c_str(),(int)token.size(),token.data(),(int)value_.size(),value_.data(),lineNumber_,(int)position+1);
       return true;
    }
 
@@ -349,15 +473,14 @@ bool keywordPair::loadInt (string *token, string *value_, int lineNumber_)
    if (checkLimits && ! int_limit_checks (token, lineNumber_)) return true;
 
    // save it
-   keyword=*token;
-   value=*value_;
+   set_alias(token);
    lineNumber=lineNumber_;
    loaded=true;
 
    return false;
 }
 
-bool keywordPair::loadDouble (string *token, string *value_, int lineNumber_)
+bool keywordPair::loadDouble (string_view token, string_view value_, int lineNumber_)
 {
    // check for duplicate
    if (loaded) {
@@ -366,18 +489,17 @@ bool keywordPair::loadDouble (string *token, string *value_, int lineNumber_)
       return true;
    }
 
-   // check for a pure number
-   if (!is_double(value_)) {
-      prefix(); PetscPrintf(PETSC_COMM_WORLD,"%s%sERROR1111: %s value at line %d is invalid.\n",
-                                             indent.c_str(),indent.c_str(),token->c_str(),lineNumber_);
+   // get the value
+   size_t position;
+   int result=parse_double(value_,&dbl_value,&position);
+   if (result == PARSE_INVALID) {
+      prefix(); PetscPrintf(PETSC_COMM_WORLD,"%s%sERROR1111: %.*s value \"%.*s\" at line %d is invalid at character %d.\n",
+                                             indent.c_str(),indent.c_str(),(int)token.size(),token.data(),(int)value_.size(),value_.data(),lineNumber_,(int)position+1);
       return true;
    }
-
-   // get the value
-   try {dbl_value=stod(*value_);}
-   catch (const std::invalid_argument& ia) {
-      prefix(); PetscPrintf(PETSC_COMM_WORLD,"%s%sERROR1113: %s value at line %d is invalid.\n",
-                                              indent.c_str(),indent.c_str(),token->c_str(),lineNumber_);
+   if (result == PARSE_OUT_OF_RANGE) {
+      prefix(); PetscPrintf(PETSC_COMM_WORLD,"%s%sERROR1113: %.*s value \"%.*s\" at line %d is out of range at character %d.\n",
+                                              indent.c_str(),indent.c_str(),(int)token.size(),token.data(),(int)value_.size(),value_.data(),lineNumber_,(int)position+1);
       return true;
    }
 
@@ -385,15 +507,14 @@ bool keywordPair::loadDouble (string *token, string *value_, int lineNumber_)
    if (checkLimits && ! dbl_limit_checks (token, lineNumber_)) return true;
 
    // save it
-   keyword=*token;
-   value=*value_;
+   set_alias(token);
    lineNumber=lineNumber_;
    loaded=true;
 
    return false;
 }
 
-bool keywordPair::loadPoint (int dim, string *token, string *value_, int lineNumber_)
+bool keywordPair::loadPoint (int dim, string_view token, string_view value_, int lineNumber_)
 {
    // check for duplicate
    if (loaded) {
@@ -402,33 +523,33 @@ bool keywordPair::loadPoint (int dim, string *token, string *value_, int lineNum
       return true;
    }
 
-   // check
-   if (!is_point(value_,dim)) {
-      prefix(); PetscPrintf(PETSC_COMM_WORLD,"%s%sERROR1115: %s value at line %d is invalid.\n",
-                                             indent.c_str(),indent.c_str(),token->c_str(),lineNumber_);
+   // get values
+   size_t position;
+   if (parse_point(value_,dim,&point_value.x,&point_value.y,&point_value.z,&position) != PARSE_OK) {
+      prefix(); PetscPrintf(PETSC_COMM_WORLD,"%s%sERROR1115: %.*s value \"%.*s\" at line %d is invalid at character %d.\n",
+                                             indent.c_str(),indent.c_str(),(int)token.size(),token.data(),(int)value_.size(),value_.data(),lineNumber_,(int)position+1);
       return true;
    }
-
-   // get values
-   if (point_get (value_, &point_value.x, &point_value.y, &point_value.z, dim, indent, lineNumber_)) return true;
    point_value.dim=dim;
 
    // check the limits
    if (checkLimits && ! point_limit_checks (token, lineNumber_)) return true;
 
+   set_alias(token);
+   lineNumber=lineNumber_;
    point_value.dim=dim;
    loaded=true;
 
    return false;
 }
 
-bool keywordPair::int_compare (keywordPair *test)
+bool keywordPair::int_compare (const keywordPair *test) const
 {
    if (int_value == test->int_value) return true;
    return false;
 }
 
-bool keywordPair::dbl_compare (keywordPair *test)
+bool keywordPair::dbl_compare (const keywordPair *test) const
 {
    if (dbl_value == test->dbl_value) return true;
    if (dbl_value == 0 && fabs(test->dbl_value) < dbl_tolerance) return true;
@@ -437,13 +558,13 @@ bool keywordPair::dbl_compare (keywordPair *test)
    return false;
 }
 
-bool keywordPair::value_compare (keywordPair *test)
+bool keywordPair::value_compare (const keywordPair *test) const
 {
-   if (value.compare(test->value) == 0) return true;
+   if (get_value().compare(test->get_value()) == 0) return true;
    return false;
 }
 
-bool keywordPair::point_compare (keywordPair *a)
+bool keywordPair::point_compare (const keywordPair *a) const
 {
    if (point_value.dim != a->point_value.dim) return false;
    if (! double_compare(point_value.x,a->point_value.x,dbl_tolerance)) return false;
@@ -452,7 +573,7 @@ bool keywordPair::point_compare (keywordPair *a)
    return true;
 }
 
-double keywordPair::get_point_distance (keywordPair *p)
+double keywordPair::get_point_distance (const keywordPair *p) const
 {
    if (point_value.dim != p->point_value.dim) return -DBL_MAX;
    struct point a=get_point_value();
@@ -460,18 +581,18 @@ double keywordPair::get_point_distance (keywordPair *p)
    return point_magnitude(point_subtraction(a,b));
 }
 
-bool keywordPair::is_close_point (keywordPair *a)
+bool keywordPair::is_close_point (const keywordPair *a) const
 {
    return point_comparison(get_point_value(),a->get_point_value(),1e-12);
 }
 
 // note the change in tolerance from above
-bool keywordPair::is_close_point (struct point p)
+bool keywordPair::is_close_point (struct point p) const
 {
    return point_comparison(get_point_value(),p,1e-8);
 }
 
-double keywordPair::distance_to_point (struct point b)
+double keywordPair::distance_to_point (struct point b) const
 {
    struct point a=get_point_value();
    a=point_subtraction(a,b);
@@ -480,56 +601,118 @@ double keywordPair::distance_to_point (struct point b)
 
 void keywordPair::copy (keywordPair a)
 {
-   aliases.clear();
-   long unsigned int i=0;
-   while (i < a.aliases.size()) {
-      aliases.push_back(a.aliases[i]);
-      i++;
-   }
-
-   keyword=a.keyword;
-   value=a.value;
-   lineNumber=a.lineNumber;
-   int_value=a.int_value;
-   dbl_value=a.dbl_value;
-   bool_value=a.bool_value;
-   point_value=a.point_value;
-   loaded=a.loaded;
-   lowerLimit=a.lowerLimit;
-   upperLimit=a.upperLimit;
-   positive_required=a.positive_required;
-   non_negative_required=a.non_negative_required;
-   indent=a.indent;
-   dbl_tolerance=a.dbl_tolerance;
-   checkLimits=a.checkLimits;
+   *this=a;
 }
 
-keywordPair* keywordPair::clone ()
+keywordPair* keywordPair::clone () const
 {
    keywordPair *b=new keywordPair();
    b->copy(*this);
    return b;
 }
 
+// append to a binary image, such as for the materials cache
+// the schema is not saved, so restore into a keywordPair given the same schema
+void keywordPair::save (string *image)
+{
+   bool hasSettings=false;
+   if (settings) hasSettings=true;
+   image_put(image,&hasSettings,sizeof(bool));
+   if (hasSettings) {
+      size_t count=settings->aliases.size();
+      image_put(image,&count,sizeof(size_t));
+      long unsigned int i=0;
+      while (i < settings->aliases.size()) {
+         image_put_string(image,settings->aliases[i]);
+         i++;
+      }
+      image_put(image,&settings->lowerLimit,sizeof(double));
+      image_put(image,&settings->upperLimit,sizeof(double));
+      image_put(image,&settings->positive_required,sizeof(bool));
+      image_put(image,&settings->non_negative_required,sizeof(bool));
+   }
+
+   bool hasText=false;
+   if (text) hasText=true;
+   image_put(image,&hasText,sizeof(bool));
+   if (hasText) image_put_string(image,*text);
+
+   image_put(image,&lineNumber,sizeof(int));
+   image_put(image,&point_value,sizeof(struct point));
+   image_put(image,&alias,sizeof(unsigned char));
+   image_put(image,&any,sizeof(bool));
+   image_put(image,&loaded,sizeof(bool));
+   image_put(image,&checkLimits,sizeof(bool));
+}
+
+// return true on fail
+bool keywordPair::restore (const char **position, const char *end)
+{
+   bool hasSettings;
+   if (image_get(position,end,&hasSettings,sizeof(bool))) return true;
+
+   delete settings;
+   settings=nullptr;
+   if (hasSettings) {
+      settings=new keywordSettings();
+
+      size_t count;
+      if (image_get(position,end,&count,sizeof(size_t))) return true;
+      long unsigned int i=0;
+      while (i < count) {
+         string alias;
+         if (image_get_string(position,end,&alias)) return true;
+         settings->aliases.push_back(alias);
+         i++;
+      }
+      if (image_get(position,end,&settings->lowerLimit,sizeof(double))) return true;
+      if (image_get(position,end,&settings->upperLimit,sizeof(double))) return true;
+      if (image_get(position,end,&settings->positive_required,sizeof(bool))) return true;
+      if (image_get(position,end,&settings->non_negative_required,sizeof(bool))) return true;
+   }
+
+   bool hasText;
+   if (image_get(position,end,&hasText,sizeof(bool))) return true;
+   delete text;
+   text=nullptr;
+   if (hasText) {
+      text=new string();
+      if (image_get_string(position,end,text)) return true;
+   }
+
+   if (image_get(position,end,&lineNumber,sizeof(int))) return true;
+   if (image_get(position,end,&point_value,sizeof(struct point))) return true;
+   if (image_get(position,end,&alias,sizeof(unsigned char))) return true;
+   if (image_get(position,end,&any,sizeof(bool))) return true;
+   if (image_get(position,end,&loaded,sizeof(bool))) return true;
+   if (image_get(position,end,&checkLimits,sizeof(bool))) return true;
+
+   return false;
+}
+
 void keywordPair::print()
 {
   long unsigned int i=0;
-  while (i < aliases.size()) {
-     prefix(); PetscPrintf(PETSC_COMM_WORLD,"alias: %s\n",aliases[i].c_str());
+  while (settings && i < settings->aliases.size()) {
+     prefix(); PetscPrintf(PETSC_COMM_WORLD,"alias: %s\n",settings->aliases[i].c_str());
+     i++;
+  }
+  i=0;
+  while (!settings && schema && i < KEYWORD_MAX_ALIASES && schema->aliases[i]) {
+     prefix(); PetscPrintf(PETSC_COMM_WORLD,"alias: %s\n",schema->aliases[i]);
      i++;
   }
-  prefix(); PetscPrintf(PETSC_COMM_WORLD,"keyword: %s\n",keyword.c_str());
-  prefix(); PetscPrintf(PETSC_COMM_WORLD,"value: %s\n",value.c_str());
+  prefix(); PetscPrintf(PETSC_COMM_WORLD,"keyword: %s\n",get_keyword().c_str());
+  prefix(); PetscPrintf(PETSC_COMM_WORLD,"value: %s\n",get_value().c_str());
   prefix(); PetscPrintf(PETSC_COMM_WORLD,"lineNumber: %d\n",lineNumber);
   prefix(); PetscPrintf(PETSC_COMM_WORLD,"int_value: %d\n",int_value);
   prefix(); PetscPrintf(PETSC_COMM_WORLD,"dbl_value: %g\n",dbl_value);
   prefix(); PetscPrintf(PETSC_COMM_WORLD,"loaded: %d\n",loaded);
-  prefix(); PetscPrintf(PETSC_COMM_WORLD,"lowerLimit: %g\n",lowerLimit);
-  prefix(); PetscPrintf(PETSC_COMM_WORLD,"upperLimit: %g\n",upperLimit);
-  prefix(); PetscPrintf(PETSC_COMM_WORLD,"postive_required: %d\n",positive_required);
-  prefix(); PetscPrintf(PETSC_COMM_WORLD,"non_negative_required: %d\n",non_negative_required);
+  prefix(); PetscPrintf(PETSC_COMM_WORLD,"lowerLimit: %g\n",get_lowerLimit());
+  prefix(); PetscPrintf(PETSC_COMM_WORLD,"upperLimit: %g\n",get_upperLimit());
+  prefix(); PetscPrintf(PETSC_COMM_WORLD,"postive_required: %d\n",get_positive_required());
+  prefix(); PetscPrintf(PETSC_COMM_WORLD,"non_negative_required: %d\n",get_non_negative_required());
   prefix(); PetscPrintf(PETSC_COMM_WORLD,"indent: [%s]\n",indent.c_str());
   prefix(); PetscPrintf(PETSC_COMM_WORLD,"dbl_tolerance: %g\n",dbl_tolerance);
   prefix(); PetscPrintf(PETSC_COMM_WORLD,"checkLimits: %d\n",checkLimits);
 }
-
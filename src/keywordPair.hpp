@@ -55,34 +55,139 @@ struct point point_scale (double, struct point);
 struct point point_midpoint (struct point, struct point);
 struct point point_cross_product (struct point, struct point);
 
+// Settings shared by every keyword of one kind, held in a constexpr table per block type
+// so that each keywordPair carries only what is parsed into it.
+#define KEYWORD_MAX_ALIASES 6
+
+struct keywordSchema {
+   const char *aliases[KEYWORD_MAX_ALIASES];   // token name plus aliases, unused entries are nullptr
+   double lowerLimit;
+   double upperLimit;
+   bool positive_required;
+   bool non_negative_required;
+};
+
+// FNV-1a, constexpr so that the dispatch tables below are built by the compiler
+constexpr unsigned long long keyword_hash (string_view a)
+{
+   unsigned long long hash=14695981039346656037ULL;
+   long unsigned int i=0;
+   while (i < a.size()) {
+      hash^=(unsigned char)a[i];
+      hash*=1099511628211ULL;
+      i++;
+   }
+   return hash;
+}
+
+// Compile-time perfect hash from the aliases of a schema to the index of their keyword in the schema.
+// The table size and bucket shift are searched at compile time until every alias has its own bucket,
+// so find () is one hash, one bucket and one string compare.
+#define KEYWORD_DISPATCH_SIZE 64
+
+template <size_t N>
+class keywordDispatch
+{
+   private:
+      const char *aliases[KEYWORD_DISPATCH_SIZE];
+      int slots[KEYWORD_DISPATCH_SIZE];
+      unsigned long long mask;
+      int shift;
+      bool perfect;
+
+      constexpr bool fill (const keywordSchema (&schema)[N], unsigned long long mask_, int shift_) {
+         int i=0;
+         while (i < KEYWORD_DISPATCH_SIZE) {aliases[i]=nullptr; slots[i]=-1; i++;}
+         size_t j=0;
+         while (j < N) {
+            int k=0;
+            while (k < KEYWORD_MAX_ALIASES && schema[j].aliases[k]) {
+               unsigned long long bucket=(keyword_hash(schema[j].aliases[k])>>shift_)&mask_;
+               if (slots[bucket] >= 0) return false;
+               aliases[bucket]=schema[j].aliases[k];
+               slots[bucket]=j;
+               k++;
+            }
+            j++;
+         }
+         return true;
+      }
+   public:
+      constexpr keywordDispatch (const keywordSchema (&schema)[N]) : aliases{}, slots{}, mask(0), shift(0), perfect(false) {
+         unsigned long long size=1;
+         while (!perfect && size <= KEYWORD_DISPATCH_SIZE) {
+            int s=0;
+            while (!perfect && s < 56) {
+               if (fill(schema,size-1,s)) {mask=size-1; shift=s; perfect=true;}
+               s++;
+            }
+            size*=2;
+         }
+      }
+      constexpr bool is_perfect () const {return perfect;}
+
+      // index in the schema, or -1 if token is not an alias
+      int find (string_view token) const {
+         unsigned long long bucket=(keyword_hash(token)>>shift)&mask;
+         if (slots[bucket] < 0 || token.compare(aliases[bucket]) != 0) return -1;
+         return slots[bucket];
+      }
+};
+
+// Aliases, limits and requirements for a keywordPair set up one setting at a time instead of from a
+// keywordSchema.  Allocated on first use, so keywordPairs loaded through a schema do not carry them.
+struct keywordSettings {
+   vector<string> aliases;  // token name plus aliases ex. "frequency", "freq", "f"
+   double lowerLimit=-DBL_MAX;
+   double upperLimit=DBL_MAX;
+   bool positive_required=false;
+   bool non_negative_required=false;
+};
+
+// Holds what is parsed for one keyword: the line number and a single typed value.  The keyword is the alias
+// matched in the input file, kept as an index into the schema or settings aliases, and "any" is a flag.
+// Only keywords taking text, such as a name, allocate a string for it.
 class keywordPair
 {
    private:
-      vector<string> aliases;  // token name plus aliases ex. "frequency", "freq", "f"
-      string keyword;          // the text value from the input file
-      string value;            // the text value from the input file
+      const keywordSchema *schema=nullptr;
+      keywordSettings *settings=nullptr;  // overrides schema when set
+      string *text=nullptr;               // the text value from the input file for text keywords, allocated on first use
       int lineNumber;
 
-      int int_value;
-      double dbl_value;
-      bool bool_value;
-      struct point point_value;
+      // one value, by the type of the keyword
+      union {
+         int int_value;
+         double dbl_value;
+         bool bool_value;
+         struct point point_value;
+      };
 
+      unsigned char alias=0;   // index of the alias used in the input file
+      bool any=false;          // the value is "any"
       bool loaded;
+      bool checkLimits=true;
 
-      double lowerLimit;
-      double upperLimit;
-      bool positive_required;
-      bool non_negative_required;
+      inline static const string indent="   ";  // for error messages
+      static constexpr double dbl_tolerance=1e-14;
 
-      string indent="   ";  // for error messages
-      double dbl_tolerance=1e-14;
-      bool checkLimits=true;
+      keywordSettings* get_settings ();
+      void set_alias (string_view);
+      double get_lowerLimit () {if (settings) return settings->lowerLimit; if (schema) return schema->lowerLimit; return -DBL_MAX;}
+      double get_upperLimit () {if (settings) return settings->upperLimit; if (schema) return schema->upperLimit; return DBL_MAX;}
+      bool get_positive_required () {if (settings) return settings->positive_required; if (schema) return schema->positive_required; return false;}
+      bool get_non_negative_required () {if (settings) return settings->non_negative_required; if (schema) return schema->non_negative_required; return false;}
    public:
-      void push_alias (string a) {aliases.push_back(a);}
-      bool match_alias (string *);
-      void set_keyword (string a) {keyword=a;}
-      void set_value (string a) {value=a;}
+      keywordPair () {}
+      keywordPair (const keywordPair &);
+      keywordPair& operator= (const keywordPair &);
+      ~keywordPair () {delete settings; delete text;}
+      void push_alias (string a) {get_settings()->aliases.push_back(a);}
+      void set_schema (const keywordSchema *, bool);
+      bool match_alias (string_view);
+      bool match_alias (string *token) {return match_alias(string_view(*token));}
+      void set_keyword (string_view a) {set_alias(a);}
+      void set_value (string_view);
       void set_int_value (int i) {int_value=i;}
       void set_point_value_dim (int dim_) {point_value.dim=dim_;}
       void set_point_value (double x, double y) {point_value.x=x; point_value.y=y; point_value.dim=2;}
@@ -92,44 +197,52 @@ class keywordPair
       void set_bool_value (bool a) {bool_value=a;}
       void set_lineNumber (int a) {lineNumber=a;}
       void set_loaded (bool a) {loaded=a;}
-      void set_positive_required (bool a) {positive_required=a;}
-      void set_non_negative_required (bool a) {non_negative_required=a;}
-      void set_lowerLimit (double a) {lowerLimit=a;}
-      void set_upperLimit (double a) {upperLimit=a;}
+      void set_positive_required (bool a) {get_settings()->positive_required=a;}
+      void set_non_negative_required (bool a) {get_settings()->non_negative_required=a;}
+      void set_lowerLimit (double a) {get_settings()->lowerLimit=a;}
+      void set_upperLimit (double a) {get_settings()->upperLimit=a;}
       void set_checkLimits (bool a) {checkLimits=a;}
-      bool is_loaded () {return loaded;}
-      string get_keyword () {return keyword;} 
-      string get_value () {return value;}
-      int get_lineNumber () {return lineNumber;}
-      int get_int_value () {return int_value;}
-      struct point get_point_value () {return point_value;}
-      int get_point_value_dim () {return point_value.dim;}
-      bool is_close_point (keywordPair *);
-      bool is_close_point (struct point);
-      double distance_to_point (struct point);
-      double get_dbl_value () {return dbl_value;}
-      bool get_bool_value () {return bool_value;}
-      bool int_compare (keywordPair *);
-      bool dbl_compare (keywordPair *);
-      bool value_compare (keywordPair *);
-      bool point_compare (keywordPair *);
-      double get_point_distance (keywordPair *);
-      bool loadBool (string *, string *, int);
-      bool loadInt (string *, string *, int);
-      bool loadDouble (string *, string *, int);
-      bool loadPoint (int, string *, string *, int);
-      bool int_limit_checks (string *, int);
-      bool dbl_limit_checks (string *, int);
-      bool point_limit_checks (string *, int);
+      bool is_loaded () const {return loaded;}
+      string get_keyword () const;
+      string get_value () const;
+      int get_lineNumber () const {return lineNumber;}
+      int get_int_value () const {return int_value;}
+      struct point get_point_value () const {return point_value;}
+      int get_point_value_dim () const {return point_value.dim;}
+      bool is_close_point (const keywordPair *) const;
+      bool is_close_point (struct point) const;
+      double distance_to_point (struct point) const;
+      double get_dbl_value () const {return dbl_value;}
+      bool get_bool_value () const {return bool_value;}
+      bool int_compare (const keywordPair *) const;
+      bool dbl_compare (const keywordPair *) const;
+      bool value_compare (const keywordPair *) const;
+      bool point_compare (const keywordPair *) const;
+      double get_point_distance (const keywordPair *) const;
+      bool loadBool (string_view, string_view, int);
+      bool loadInt (string_view, string_view, int);
+      bool loadDouble (string_view, string_view, int);
+      bool loadPoint (int, string_view, string_view, int);
+      bool int_limit_checks (string_view, int);
+      bool dbl_limit_checks (string_view, int);
+      bool point_limit_checks (string_view, int);
+
+      // for callers holding strings
+      bool loadBool (string *token, string *value_, int lineNumber_) {return loadBool(string_view(*token),string_view(*value_),lineNumber_);}
+      bool loadInt (string *token, string *value_, int lineNumber_) {return loadInt(string_view(*token),string_view(*value_),lineNumber_);}
+      bool loadDouble (string *token, string *value_, int lineNumber_) {return loadDouble(string_view(*token),string_view(*value_),lineNumber_);}
+      bool loadPoint (int dim, string *token, string *value_, int lineNumber_) {return loadPoint(dim,string_view(*token),string_view(*value_),lineNumber_);}
+      bool int_limit_checks (string *keyword_, int lineNumber_) {return int_limit_checks(string_view(*keyword_),lineNumber_);}
+      bool dbl_limit_checks (string *keyword_, int lineNumber_) {return dbl_limit_checks(string_view(*keyword_),lineNumber_);}
+      bool point_limit_checks (string *keyword_, int lineNumber_) {return point_limit_checks(string_view(*keyword_),lineNumber_);}
       bool limit_check (string);
 
       void copy (keywordPair a);
-      keywordPair* clone ();
+      keywordPair* clone () const;
+      void save (string *);
+      bool restore (const char **, const char *);
 
-      bool is_any () {
-         if (value.compare("any") == 0) return true;
-         return false;
-      }
+      bool is_any () const {return any;}
       void print ();
 };
 
@@ -0,0 +1,122 @@
+////////////////////////////////////////////////////////////////////////////////
+//                                                                            //
+//    OpenParEM2D - A fullwave 2D electromagnetic simulator.                  //
+//    Copyright (C) 2025 Brian Young                                          //
+//                                                                            //
+//    This program is free software: you can redistribute it and/or modify    //
+//    it under the terms of the GNU General Public License as published by    //
+//    the Free Software Foundation, either version 3 of the License, or       //
+//    (at your option) any later version.                                     //
+//                                                                            //
+//    This program is distributed in the hope that it will be useful,         //
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of          //
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the           //
+//    GNU General Public License for more details.                            //
+//                                                                            //
+//    You should have received a copy of the GNU General Public License       //
+//    along with this program.  If not, see <http://www.gnu.org/licenses/>.   //
+//                                                                            //
+////////////////////////////////////////////////////////////////////////////////
+
+#include "materialSnapshot.hpp"
+
+// call after reset_attributes so that the attributes are numbered 1 to get_attributeCount
+bool MaterialSnapshot::build (MeshMaterialList *meshMaterials, MaterialDatabase *materialDatabase, double frequency_, double temperature_)
+{
+   frequency=frequency_;
+   temperature=temperature_;
+
+   int count=meshMaterials->get_attributeCount();
+   eps.assign(count,complex<double>(-DBL_MAX,0));
+   mu.assign(count,-DBL_MAX);
+   Rs.assign(count,-DBL_MAX);
+
+   // each material is evaluated once no matter how many attributes use it
+   vector<string> nameList;
+   vector<int> materialList(count,-1);
+   int attribute=1;
+   while (attribute <= count) {
+      long unsigned int m;
+      if (meshMaterials->find_index(attribute-1,&m)) {
+         string name=meshMaterials->get_name(m);
+         long unsigned int i=0;
+         while (i < nameList.size()) {
+            if (nameList[i].compare(name) == 0) break;
+            i++;
+         }
+         if (i == nameList.size()) nameList.push_back(name);
+         materialList[attribute-1]=i;
+      } else {
+         prefix(); PetscPrintf(PETSC_COMM_WORLD,"ERROR1141: Mesh attribute %d does not have a material.\n",attribute);
+         return true;
+      }
+      attribute++;
+   }
+
+   vector<double> frequencyList(1,frequency);
+   vector<vector<complex<double>>> epsList;
+   vector<vector<double>> muList,RsList;
+   if (materialDatabase->evaluate(&nameList,temperature,&frequencyList,&epsList,&muList,&RsList)) return true;
+
+   int i=0;
+   while (i < count) {
+      eps[i]=epsList[materialList[i]][0];
+      mu[i]=muList[materialList[i]][0];
+      Rs[i]=RsList[materialList[i]][0];
+      i++;
+   }
+
+   return false;
+}
+
+void MaterialSnapshot::get_eps_real (Vector *values)
+{
+   values->SetSize(eps.size());
+   long unsigned int i=0;
+   while (i < eps.size()) {
+      (*values)(i)=real(eps[i]);
+      i++;
+   }
+}
+
+void MaterialSnapshot::get_eps_imag (Vector *values)
+{
+   values->SetSize(eps.size());
+   long unsigned int i=0;
+   while (i < eps.size()) {
+      (*values)(i)=imag(eps[i]);
+      i++;
+   }
+}
+
+void MaterialSnapshot::get_mu (Vector *values)
+{
+   values->SetSize(mu.size());
+   long unsigned int i=0;
+   while (i < mu.size()) {
+      (*values)(i)=mu[i];
+      i++;
+   }
+}
+
+void MaterialSnapshot::get_Rs (Vector *values)
+{
+   values->SetSize(Rs.size());
+   long unsigned int i=0;
+   while (i < Rs.size()) {
+      (*values)(i)=Rs[i];
+      i++;
+   }
+}
+
+void MaterialSnapshot::print (string indent)
+{
+   prefix(); PetscPrintf(PETSC_COMM_WORLD,"%sMaterial snapshot at %g Hz and %g degrees:\n",indent.c_str(),frequency,temperature);
+   long unsigned int i=0;
+   while (i < eps.size()) {
+      prefix(); PetscPrintf(PETSC_COMM_WORLD,"%s   attribute %ld: eps=(%g,%g) mu=%g",indent.c_str(),i+1,real(eps[i]),imag(eps[i]),mu[i]);
+      if (Rs[i] != -DBL_MAX) PetscPrintf(PETSC_COMM_WORLD," Rs=%g",Rs[i]);
+      PetscPrintf(PETSC_COMM_WORLD,"\n");
+      i++;
+   }
+}
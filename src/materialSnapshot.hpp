@@ -0,0 +1,64 @@
+////////////////////////////////////////////////////////////////////////////////
+//                                                                            //
+//    OpenParEM2D - A fullwave 2D electromagnetic simulator.                  //
+//    Copyright (C) 2025 Brian Young                                          //
+//                                                                            //
+//    This program is free software: you can redistribute it and/or modify    //
+//    it under the terms of the GNU General Public License as published by    //
+//    the Free Software Foundation, either version 3 of the License, or       //
+//    (at your option) any later version.                                     //
+//                                                                            //
+//    This program is distributed in the hope that it will be useful,         //
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of          //
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the           //
+//    GNU General Public License for more details.                            //
+//                                                                            //
+//    You should have received a copy of the GNU General Public License       //
+//    along with this program.  If not, see <http://www.gnu.org/licenses/>.   //
+//                                                                            //
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef MATERIALSNAPSHOT_H
+#define MATERIALSNAPSHOT_H
+
+#include "mfem.hpp"
+#include <string>
+#include <vector>
+#include <complex>
+#include "petscsys.h"
+#include "mesh.hpp"
+#include "OpenParEMmaterials.hpp"
+#include "prefix.h"
+
+using namespace std;
+using namespace mfem;
+
+extern "C" void prefix ();
+
+// Material properties at one frequency and temperature indexed by the renumbered mesh attribute,
+// built once per frequency from the MeshMaterialList and MaterialDatabase join, so that a per-element
+// lookup is one array load.  Attribute a is at index a-1, which is also the layout of the Vector
+// for a PWConstCoefficient.  Rs is -DBL_MAX for materials that are not conductors.
+class MaterialSnapshot {
+   private:
+      double frequency=0;
+      double temperature=0;
+      vector<complex<double>> eps;
+      vector<double> mu;
+      vector<double> Rs;
+   public:
+      bool build (MeshMaterialList *, MaterialDatabase *, double, double);
+      double get_frequency () {return frequency;}
+      double get_temperature () {return temperature;}
+      int size () {return eps.size();}
+      complex<double> get_eps (int attribute) {return eps[attribute-1];}
+      double get_mu (int attribute) {return mu[attribute-1];}
+      double get_Rs (int attribute) {return Rs[attribute-1];}
+      void get_eps_real (Vector *);
+      void get_eps_imag (Vector *);
+      void get_mu (Vector *);
+      void get_Rs (Vector *);
+      void print (string);
+};
+
+#endif
@@ -357,6 +357,243 @@ void reset_attributes (Mesh *mesh, ParMesh *pmesh, MeshMaterialList *meshMateria
    if (pmesh) pmesh->SetAttributes();
 }
 
+// FNV-1a
+static void hash_bytes (unsigned long long *hash, const void *data, size_t length)
+{
+   const unsigned char *bytes=(const unsigned char *) data;
+   size_t i=0;
+   while (i < length) {
+      *hash^=bytes[i];
+      *hash*=1099511628211ULL;
+      i++;
+   }
+}
+
+static void hash_vertex (unsigned long long *hash, const double *vertex, int dim)
+{
+   int i=0;
+   while (i < dim) {
+      double coordinate=vertex[i];
+      if (coordinate == 0) coordinate=0;   // -0 and 0 hash the same
+      hash_bytes(hash,&coordinate,sizeof(double));
+      i++;
+   }
+}
+
+// spread the bits before the elements are summed
+static unsigned long long hash_mix (unsigned long long hash)
+{
+   hash^=hash >> 30;
+   hash*=0xbf58476d1ce4e5b9ULL;
+   hash^=hash >> 27;
+   hash*=0x94d049bb133111ebULL;
+   hash^=hash >> 31;
+   return hash;
+}
+
+// Content hash of a mesh from the attribute and vertex coordinates of each element and boundary element.
+// Element hashes are summed, so the result does not depend on element order or on the partitioning of a ParMesh.
+// Collective on the communicator of pmesh.
+unsigned long long mesh_hash (Mesh *mesh, ParMesh *pmesh)
+{
+   Mesh *localMesh=mesh;
+   if (pmesh) localMesh=pmesh;
+
+   int dim=localMesh->SpaceDimension();
+
+   unsigned long long hash=0;
+   Array<int> vertices;
+
+   int i=0;
+   while (i < localMesh->GetNE()) {
+      unsigned long long elementHash=14695981039346656037ULL;
+      int attribute=localMesh->GetAttribute(i);
+      hash_bytes(&elementHash,&attribute,sizeof(int));
+      localMesh->GetElementVertices(i,vertices);
+      int j=0;
+      while (j < vertices.Size()) {
+         hash_vertex(&elementHash,localMesh->GetVertex(vertices[j]),dim);
+         j++;
+      }
+      hash+=hash_mix(elementHash);
+      i++;
+   }
+
+   i=0;
+   while (i < localMesh->GetNBE()) {
+      unsigned long long elementHash=1099511628211ULL;   // distinct from the elements
+      int attribute=localMesh->GetBdrAttribute(i);
+      hash_bytes(&elementHash,&attribute,sizeof(int));
+      localMesh->GetBdrElementVertices(i,vertices);
+      int j=0;
+      while (j < vertices.Size()) {
+         hash_vertex(&elementHash,localMesh->GetVertex(vertices[j]),dim);
+         j++;
+      }
+      hash+=hash_mix(elementHash);
+      i++;
+   }
+
+   if (pmesh) {
+      unsigned long long localHash=hash;
+      MPI_Allreduce(&localHash,&hash,1,MPI_UNSIGNED_LONG_LONG,MPI_SUM,pmesh->GetComm());
+   }
+
+   // reserve 0 for unknown
+   if (hash == 0) hash=1;
+
+   return hash;
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////
+// MeshCache
+///////////////////////////////////////////////////////////////////////////////////////////
+
+MeshCache::MeshCache (long unsigned int budget_, string directory_)
+{
+   budget=budget_;
+   directory=directory_;
+   if (directory.length() > 0) std::filesystem::create_directories(directory);
+}
+
+// approximate in-memory footprint of the local part of the mesh
+// the maximum over the ranks keeps the cache decisions the same on all ranks
+long unsigned int MeshCache::estimate_bytes (ParMesh *pmesh)
+{
+   long unsigned int bytes=(long unsigned int)pmesh->GetNV()*3*sizeof(double)+
+                           (long unsigned int)pmesh->GetNE()*8*sizeof(int)+
+                           (long unsigned int)pmesh->GetNBE()*6*sizeof(int);
+   long unsigned int maxBytes;
+   MPI_Allreduce(&bytes,&maxBytes,1,MPI_UNSIGNED_LONG,MPI_MAX,pmesh->GetComm());
+   return maxBytes;
+}
+
+void MeshCache::remove (double frequency)
+{
+   if (meshList.count(frequency) > 0) {
+      delete meshList[frequency];
+      meshList.erase(frequency);
+   }
+   if (fileList.count(frequency) > 0) {
+      std::filesystem::remove(fileList[frequency]);
+      fileList.erase(frequency);
+   }
+   used-=bytesList[frequency];
+   bytesList.erase(frequency);
+   passesList.erase(frequency);
+}
+
+// keep a copy of the mesh refined at frequency with the given number of refinement passes
+// the meshes farthest in frequency are dropped to make room
+// returns true if the mesh does not fit
+bool MeshCache::store (double frequency, ParMesh *pmesh, int passes)
+{
+   PetscMPIInt rank;
+   MPI_Comm_rank(pmesh->GetComm(),&rank);
+
+   long unsigned int bytes=estimate_bytes(pmesh);
+   if (bytes > budget) return true;
+
+   if (bytesList.count(frequency) > 0) remove(frequency);
+
+   while (used+bytes > budget && bytesList.size() > 0) {
+      double farthest=bytesList.begin()->first;
+      if (abs(bytesList.rbegin()->first-frequency) > abs(farthest-frequency)) farthest=bytesList.rbegin()->first;
+      remove(farthest);
+   }
+
+   if (directory.length() > 0) {
+      stringstream ss;
+      ss << directory << "/mesh." << fileCount << "." << rank;
+      fileCount++;
+      ofstream meshFile;
+      meshFile.open(ss.str().c_str(),ofstream::out);
+      int fail=0;
+      if (meshFile.is_open()) {
+         meshFile.precision(17);
+         pmesh->ParPrint(meshFile);
+         meshFile.close();
+      } else {
+         fail=1;
+      }
+      int anyFail;
+      MPI_Allreduce(&fail,&anyFail,1,MPI_INT,MPI_MAX,pmesh->GetComm());
+      if (anyFail) {
+         std::filesystem::remove(ss.str());
+         return true;
+      }
+      fileList[frequency]=ss.str();
+   } else {
+      meshList[frequency]=new ParMesh(*pmesh);
+   }
+
+   bytesList[frequency]=bytes;
+   passesList[frequency]=passes;
+   used+=bytes;
+
+   return false;
+}
+
+// frequency of the mesh that lookup returns, without reading it, or false if the cache is empty
+// not collective, since the cache contents are the same on all ranks
+bool MeshCache::find (double frequency, double *cachedFrequency, bool *needsCoarsening)
+{
+   *needsCoarsening=false;
+   if (bytesList.size() == 0) return false;
+
+   // nearest at or below, else nearest above
+   map<double,long unsigned int>::iterator it=bytesList.upper_bound(frequency);
+   if (it == bytesList.begin()) *needsCoarsening=true;
+   else it--;
+   *cachedFrequency=it->first;
+   return true;
+}
+
+// new mesh for the caller to own, or nullptr if the cache is empty
+ParMesh* MeshCache::lookup (MPI_Comm comm, double frequency, bool *needsCoarsening)
+{
+   double cachedFrequency;
+   if (!find(frequency,&cachedFrequency,needsCoarsening)) {
+      misses++;
+      return nullptr;
+   }
+
+   ParMesh *pmesh=nullptr;
+   if (fileList.count(cachedFrequency) > 0) {
+      ifstream meshFile;
+      meshFile.open(fileList[cachedFrequency].c_str(),ifstream::in);
+      int fail=0;
+      if (!meshFile.is_open()) fail=1;
+      int anyFail;
+      MPI_Allreduce(&fail,&anyFail,1,MPI_INT,MPI_MAX,comm);
+      if (!anyFail) pmesh=new ParMesh(comm,meshFile);
+      if (meshFile.is_open()) meshFile.close();
+   } else {
+      pmesh=new ParMesh(*meshList[cachedFrequency]);
+   }
+
+   if (!pmesh) {
+      misses++;
+      return nullptr;
+   }
+
+   // a finer mesh is only a saving if the caller can coarsen it, which the cache does not know
+   hits++;
+   if (!*needsCoarsening) passesSaved+=passesList[cachedFrequency];
+   return pmesh;
+}
+
+void MeshCache::report (string indent)
+{
+   prefix(); PetscPrintf(PETSC_COMM_WORLD,"%sRefined mesh cache: %d hits, %d misses, %d refinement passes saved, %g of %g MB used\n",
+                         indent.c_str(),hits,misses,passesSaved,used/1048576.,budget/1048576.);
+}
+
+MeshCache::~MeshCache ()
+{
+   while (bytesList.size() > 0) remove(bytesList.begin()->first);
+}
+
 ///////////////////////////////////////////////////////////////////////////////////////////
 // MeshMaterialList
 ///////////////////////////////////////////////////////////////////////////////////////////
@@ -453,8 +690,10 @@ int MeshMaterialList::loadGMSH (const char *filename, int dimension)
    bool startedFormat=false,completedFormat=false,loadedFormat=false;
    bool startedNames=false,completedNames=false,loadedEntryCount=false;
    string line,version_number;
-   vector<string> tokens;
-   size_t pos1,pos2;
+   lineTokenizer tokens;
+   string_view name;
+   size_t pos1,pos2,position;
+   int physicalTag;
 
    // the mesh file in Gmsh 2.2 format 
    ifstream meshFile;
@@ -491,18 +730,21 @@ int MeshMaterialList::loadGMSH (const char *filename, int dimension)
                      }
                   } else {
                      if (!loadedFormat) {
-                        split_on_space (&tokens,line);
+                        tokens.split(line);
                         if (tokens.size() != 3) {
                            prefix(); PetscPrintf(PETSC_COMM_WORLD,"ERROR1037: Incorrect number of tokens in file \"%s\" at line %d.\n",filename,lineCount);
                            meshFile.close();
                            return 1;
                         }
 
-                        version_number=tokens[0];
-                        file_type=stoi(tokens[1]);
-                        data_size=stoi(tokens[2]);
+                        version_number=tokens.get(0);
+                        if (parse_int(tokens.get(1),&file_type,&position) != PARSE_OK ||
+                            parse_int(tokens.get(2),&data_size,&position) != PARSE_OK) {
+                           prefix(); PetscPrintf(PETSC_COMM_WORLD,"ERROR1144: Invalid integer in file \"%s\" at line %d.\n",filename,lineCount);
+                           meshFile.close();
+                           return 1;
+                        }
 
-                        tokens.clear();
                         loadedFormat=true;
                      }
                   }
@@ -522,29 +764,35 @@ int MeshMaterialList::loadGMSH (const char *filename, int dimension)
                      if (! loadedEntryCount) {
                         loadedEntryCount=true;
                      } else {
-                        split_on_space (&tokens,line);
+                        tokens.split(line);
                         if (tokens.size() != 3) {
                            prefix(); PetscPrintf(PETSC_COMM_WORLD,"ERROR1039: Incorrect number of tokens in file \"%s\" at line %d.\n",filename,lineCount);
                            meshFile.close();
                            return 1;
                         }
-                        int dim=stoi(tokens[0]);
+                        int dim;
+                        if (parse_int(tokens.get(0),&dim,&position) != PARSE_OK ||
+                            parse_int(tokens.get(1),&physicalTag,&position) != PARSE_OK) {
+                           prefix(); PetscPrintf(PETSC_COMM_WORLD,"ERROR1147: Invalid integer in file \"%s\" at line %d.\n",filename,lineCount);
+                           meshFile.close();
+                           return 1;
+                        }
                         if (dim != dimension) {
                            prefix(); PetscPrintf(PETSC_COMM_WORLD,"Warning: Dimension %d!=2 in file \"%s\" at line %d.\n",dim,filename,lineCount);
                         }
 
-                        index.push_back(stoi(tokens[1])-1);
+                        index.push_back(physicalTag-1);
                         active.push_back(true);
 
                         // strip off "
-                        pos1=tokens[2].find("\"",0);
+                        name=tokens.get(2);
+                        pos1=name.find("\"",0);
                         if (pos1 >= 0) {
-                           pos2=tokens[2].rfind("\"",tokens[2].length());
-                           tokens[2]=tokens[2].substr(pos1+1,pos2-pos1-1);
+                           pos2=name.rfind("\"",name.length());
+                           name=name.substr(pos1+1,pos2-pos1-1);
                         }
 
-                        list.push_back(tokens[2]);
-                        tokens.clear();
+                        list.push_back(string(name));
                         materialCount++;
                      }
                   }
@@ -602,6 +850,32 @@ long unsigned int MeshMaterialList::get_index (int attribute)
    return 0;
 }
 
+// as get_index without the assert, returning false if no active entry has the attribute
+bool MeshMaterialList::find_index (int attribute, long unsigned int *m)
+{
+   long unsigned int i=0;
+   while (i < index.size()) {
+      if (active[i] && index[i] == attribute) {
+         *m=i;
+         return true;
+      }
+      i++;
+   }
+   return false;
+}
+
+// number of mesh attributes in use after reset_attributes
+int MeshMaterialList::get_attributeCount ()
+{
+   int count=0;
+   long unsigned int i=0;
+   while (i < index.size()) {
+      if (active[i] && index[i]+1 > count) count=index[i]+1;
+      i++;
+   }
+   return count;
+}
+
 string MeshMaterialList::get_name(long unsigned int m)
 {
    string a="ERROR1046: out of bounds";
@@ -609,6 +883,16 @@ string MeshMaterialList::get_name(long unsigned int m)
    return a;
 }
 
+// unique names of the active materials, such as for lazy loading of the materials library
+void MeshMaterialList::get_names (vector<string> *names)
+{
+   long unsigned int i=0;
+   while (i < list.size()) {
+      if (active[i] && find(names->begin(),names->end(),list[i]) == names->end()) names->push_back(list[i]);
+      i++;
+   }
+}
+
 void MeshMaterialList::print ()
 {
    prefix(); PetscPrintf(PETSC_COMM_WORLD,"MeshMaterialList:\n");
@@ -630,8 +914,10 @@ int MeshMaterialList::loadMFEM (const char *filename)
 {
    int lineCount=0;
    string line;
-   vector<string> tokens;
-   size_t pos1,pos2;
+   lineTokenizer tokens;
+   string_view name;
+   size_t pos1,pos2,position;
+   int attribute;
 
    stringstream regionsFilename;
    regionsFilename << "materials_for_" << filename;
@@ -666,26 +952,31 @@ int MeshMaterialList::loadMFEM (const char *filename)
                // chop off comments
                line=line.substr(0,line.find("//",0));
 
-               split_on_space (&tokens,line);
+               tokens.split(line);
                if (tokens.size() != 2) {
                   prefix(); PetscPrintf(PETSC_COMM_WORLD,"ERROR1048: Incorrect number of tokens in file \"%s\" at line %d.\n",filename,lineCount);
                   regionsFile.close();
                   return 1;
                }
 
-               index.push_back(stoi(tokens[0]));
+               if (parse_int(tokens.get(0),&attribute,&position) != PARSE_OK) {
+                  prefix(); PetscPrintf(PETSC_COMM_WORLD,"ERROR1148: Invalid integer in file \"%s\" at line %d.\n",filename,lineCount);
+                  regionsFile.close();
+                  return 1;
+               }
+
+               index.push_back(attribute);
                active.push_back(true);
 
                // strip off "
-               pos1=tokens[1].find("\"",0);
+               name=tokens.get(1);
+               pos1=name.find("\"",0);
                if (pos1 >= 0) {
-                  pos2=tokens[1].rfind("\"",tokens[1].length());
-                  tokens[1]=tokens[1].substr(pos1+1,pos2-pos1-1);
+                  pos2=name.rfind("\"",name.length());
+                  name=name.substr(pos1+1,pos2-pos1-1);
                }
 
-               list.push_back(tokens[1]);
-
-               tokens.clear();
+               list.push_back(string(name));
             }
          }
       }
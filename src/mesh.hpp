@@ -29,6 +29,8 @@
 #include <sstream>
 #include <vector>
 #include <string>
+#include <map>
+#include <algorithm>
 #include <filesystem>
 #include <unistd.h>
 #include "petscsys.h"
@@ -64,10 +66,48 @@ class MeshMaterialList {
        void print ();
        int size ();
        long unsigned int get_index (int);
+       bool find_index (int, long unsigned int *);
+       int get_attributeCount ();
        string get_name (long unsigned int);
+       void get_names (vector<string> *);
 };
 
 void reset_attributes (Mesh *, ParMesh *, MeshMaterialList *);
+unsigned long long mesh_hash (Mesh *, ParMesh *);
+
+// Refined meshes kept by the frequency at which they were refined so that a refining point can
+// start from the nearest refined mesh instead of the initial mesh.
+// A mesh refined at or below the requested frequency is preferred since refinement can continue
+// from it. Otherwise a finer mesh from a higher frequency is returned and flagged as needing
+// coarsening, which the caller can do for nonconforming meshes or else use as is.
+// Meshes are copied into memory, or written to directory when one is given, within a budget
+// in bytes per rank. All methods except find are collective on the communicator of the meshes.
+// The caller stores the meshes after refinement.  A FrequencyPlan given the cache with
+// set_meshCache reports from get_frequency which restarting points can start from a cached mesh.
+class MeshCache {
+   private:
+      long unsigned int budget;              // bytes
+      string directory;                      // empty to keep the meshes in memory
+      long unsigned int used=0;
+      map<double,ParMesh *> meshList;        // in memory
+      map<double,string> fileList;           // on disk
+      map<double,int> passesList;            // refinement passes that went into each mesh
+      map<double,long unsigned int> bytesList;
+      int fileCount=0;
+      int hits=0;
+      int misses=0;
+      int passesSaved=0;
+      long unsigned int estimate_bytes (ParMesh *);
+      void remove (double);
+   public:
+      MeshCache (long unsigned int, string);
+      ~MeshCache ();
+      bool store (double, ParMesh *, int);
+      bool find (double, double *, bool *);
+      ParMesh* lookup (MPI_Comm, double, bool *);
+      int get_passesSaved () {return passesSaved;}
+      void report (string);
+};
 
 class Vertex3D {
    private:
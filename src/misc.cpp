@@ -73,6 +73,119 @@ void split_on_space (vector<string> *tokens, string a) {
    while (ss >> buf) tokens->push_back(buf);
 }
 
+// same white space as operator>>
+long unsigned int lineTokenizer::split (string_view a)
+{
+   const char *space=" \t\n\v\f\r";
+
+   tokens.clear();
+   size_t first=a.find_first_not_of(space);
+   while (first != string_view::npos) {
+      size_t last=a.find_first_of(space,first);
+      if (last == string_view::npos) last=a.size();
+      tokens.push_back(a.substr(first,last-first));
+      first=a.find_first_not_of(space,last);
+   }
+   return tokens.size();
+}
+
+// compare the tokens of split_on_space and lineTokenizer on one line, returning the number of differences
+long unsigned int compare_tokenizers (lineTokenizer *tokenizer, string_view line)
+{
+   vector<string> tokens;
+   split_on_space(&tokens,string(line));
+   if (tokens.size() != tokenizer->split(line)) return 1;
+
+   long unsigned int mismatches=0;
+   long unsigned int i=0;
+   while (i < tokens.size()) {
+      if (tokens[i].compare(tokenizer->get(i)) != 0) mismatches++;
+      i++;
+   }
+   return mismatches;
+}
+
+// Check that lineTokenizer splits lines the same as split_on_space, then time both over lineCount
+// generated lines shaped like the entries of an eigenvector file.
+void test_tokenizer (long unsigned int lineCount)
+{
+   long unsigned int mismatches=0;
+   lineTokenizer tokenizer;
+
+   // white space cases
+   const char *lines[]={"",
+                        "   ",
+                        "\t\t",
+                        "one",
+                        "  one",
+                        "one  ",
+                        "one two",
+                        " one\ttwo \t three\t",
+                        "one\r",
+                        "one\vtwo\fthree",
+                        "name=value",
+                        "  point=(1, 2, 3)  ",
+                        "   1.234567890123456e-03 + 9.876543210987654e-04i",
+                        "\t-2.5e+01"};
+   long unsigned int i=0;
+   while (i < sizeof(lines)/sizeof(lines[0])) {
+      long unsigned int count=compare_tokenizers(&tokenizer,lines[i]);
+      if (count > 0) {prefix(); PetscPrintf(PETSC_COMM_WORLD,"tokenizer: case %ld FAIL\n",i);}
+      mismatches+=count;
+      i++;
+   }
+
+   string text;
+   i=0;
+   while (i < lineCount) {
+      if (i%2 == 0) text+="   1.234567890123456e-03 + 9.876543210987654e-04i\n";
+      else text+="\t-2.5e+01\n";
+      i++;
+   }
+
+   string_view view(text);
+   vector<string> tokens;
+   long unsigned int oldCount=0;
+   long unsigned int newCount=0;
+
+   chrono::steady_clock::time_point start=chrono::steady_clock::now();
+   size_t position=0;
+   while (position < view.size()) {
+      size_t end=view.find('\n',position);
+      split_on_space(&tokens,string(view.substr(position,end-position)));
+      oldCount+=tokens.size();
+      position=end+1;
+   }
+
+   chrono::steady_clock::time_point middle=chrono::steady_clock::now();
+   position=0;
+   while (position < view.size()) {
+      size_t end=view.find('\n',position);
+      newCount+=tokenizer.split(view.substr(position,end-position));
+      position=end+1;
+   }
+   chrono::steady_clock::time_point stop=chrono::steady_clock::now();
+
+   if (oldCount != newCount) mismatches++;
+
+   // token by token on the first lines
+   position=0;
+   i=0;
+   while (position < view.size() && i < 1000) {
+      size_t end=view.find('\n',position);
+      mismatches+=compare_tokenizers(&tokenizer,view.substr(position,end-position));
+      position=end+1;
+      i++;
+   }
+
+   double oldTime=chrono::duration<double>(middle-start).count();
+   double newTime=chrono::duration<double>(stop-middle).count();
+   prefix(); PetscPrintf(PETSC_COMM_WORLD,"tokenizer: %ld lines, %ld mismatches, split_on_space %g s, lineTokenizer %g s, speedup %g\n",
+                                          lineCount,mismatches,oldTime,newTime,newTime > 0 ? oldTime/newTime : 0);
+   if (mismatches == 0) {prefix(); PetscPrintf(PETSC_COMM_WORLD,"tokenizer pass\n");}
+   else {prefix(); PetscPrintf(PETSC_COMM_WORLD,"tokenizer FAIL\n");}
+}
+
 bool double_compare (double a, double b, double tol)
 {
    if (a == b) return true;
@@ -263,110 +376,157 @@ bool is_point (string *a, int dim)
    return true;
 }
 
-bool point_get (string *a, double *x_value, double *y_value, double *z_value, int dim, string indent, int lineNumber_)
+// Numbers are validated and converted in one pass over the text with from_chars.
+// Leading and trailing blanks are allowed.  A number has an optional sign followed by a digit or a
+// period, which excludes inf, nan and hex, and must use all of the text.  On failure, position is the
+// offset in the text of the offending character.
+
+int parse_double (string_view a, double *value, size_t *position)
 {
-   const char *b=(*a).c_str();
+   size_t first=a.find_first_not_of(" \t");
+   if (first == string_view::npos) {*position=a.size(); return PARSE_INVALID;}
+   size_t last=a.find_last_not_of(" \t");
+
+   size_t i=first;
+   bool negative=false;
+   if (a[i] == '+' || a[i] == '-') {negative=(a[i] == '-'); i++;}
+
+   if (i > last || !(isdigit(a[i]) || a[i] == '.')) {*position=i; return PARSE_INVALID;}
+
+#if defined(__cpp_lib_to_chars)
+   from_chars_result result=from_chars(a.data()+i,a.data()+last+1,*value,chars_format::general);
+   if (result.ec == errc::invalid_argument) {*position=i; return PARSE_INVALID;}
+   if (result.ptr != a.data()+last+1) {*position=result.ptr-a.data(); return PARSE_INVALID;}
+   if (result.ec == errc::result_out_of_range) {*position=first; return PARSE_OUT_OF_RANGE;}
+#else
+   // without floating point from_chars, fall back to strtod on a terminated copy limited to decimal forms
+   string text(a.substr(i,last-i+1));
+   size_t j=text.find_first_not_of("0123456789.eE+-");
+   if (j != string::npos) {*position=i+j; return PARSE_INVALID;}
+
+   char *end;
+   errno=0;
+   *value=strtod(text.c_str(),&end);
+   if (end != text.c_str()+text.size()) {*position=i+(end-text.c_str()); return PARSE_INVALID;}
+   if (errno == ERANGE) {*position=first; return PARSE_OUT_OF_RANGE;}
+#endif
+
+   if (negative) *value=-*value;
+   return PARSE_OK;
+}
 
-   size_t allocSize=256;
-   char x[allocSize],y[allocSize],z[allocSize];
-   size_t size_x=0, size_y=0, size_z=0;
-   bool foundOpen=false;
-   bool foundComma=false;
-   bool found2ndComma=false;
-   size_t i=0;
-   while (i < strlen(b)) {
-      if (b[i] == '(' || b[i] == ',' || b[i] == ')') {
-         if (b[i] == '(') foundOpen=true;
-         if (b[i] == ',') {
-            if (!foundComma) foundComma=true;
-            else found2ndComma=true;
-         }
-         if (b[i] == ')') break;
-      } else {
-         if (foundOpen && ! foundComma) {
-            x[size_x]=b[i];
-            size_x++;
-            if (size_x == allocSize) return false;
-         }
-         if (foundOpen && foundComma) {
-            if (!found2ndComma) {
-               y[size_y]=b[i];
-               size_y++;
-               if (size_y == allocSize) return false;
-            } else {
-               z[size_z]=b[i];
-               size_z++;
-               if (size_z == allocSize) return false;
-            }
-         }
-      }
-      i++;
-   }
+// digits only, as for is_int
+int parse_int (string_view a, int *value, size_t *position)
+{
+   size_t first=a.find_first_not_of(" \t");
+   if (first == string_view::npos) {*position=a.size(); return PARSE_INVALID;}
+   size_t last=a.find_last_not_of(" \t");
 
-   // complete the strings
-   x[size_x]='\0';
-   y[size_y]='\0';
-   if (dim == 3) z[size_z]='\0';
+   if (!isdigit(a[first])) {*position=first; return PARSE_INVALID;}
 
-   // convert to strings to use stod
-   string x_str=x;
-   string y_str=y;
-   string z_str;
-   if (dim == 3) z_str=z;
+   from_chars_result result=from_chars(a.data()+first,a.data()+last+1,*value);
+   if (result.ptr != a.data()+last+1) {*position=result.ptr-a.data(); return PARSE_INVALID;}
+   if (result.ec == errc::result_out_of_range) {*position=first; return PARSE_OUT_OF_RANGE;}
 
-   // get the values
-   try {*x_value=stod(x_str);}
-   catch (const std::invalid_argument& ia) {
-      prefix(); PetscPrintf(PETSC_COMM_WORLD,"%s%sERROR1000: %s value at line %d is invalid.\n",indent.c_str(),indent.c_str(),a->c_str(),lineNumber_);
-      return true;
-   }
+   return PARSE_OK;
+}
 
-   try {*y_value=stod(y_str);}
-   catch (const std::invalid_argument& ia) {
-      prefix(); PetscPrintf(PETSC_COMM_WORLD,"%s%sERROR1001: %s value at line %d is invalid.\n",indent.c_str(),indent.c_str(),a->c_str(),lineNumber_);
-      return true;
+// (x,y) for dim=2 or (x,y,z) for dim=3
+int parse_point (string_view a, int dim, double *x_value, double *y_value, double *z_value, size_t *position)
+{
+   size_t i=a.find_first_not_of(" \t");
+   if (i == string_view::npos || a[i] != '(') {
+      if (i == string_view::npos) *position=a.size();
+      else *position=i;
+      return PARSE_INVALID;
    }
+   i++;
 
-   if (dim == 3) {
-      try {*z_value=stod(z_str);}
-      catch (const std::invalid_argument& ia) {
-         prefix(); PetscPrintf(PETSC_COMM_WORLD,"%s%sERROR1002: %s value at line %d is invalid.\n",indent.c_str(),indent.c_str(),a->c_str(),lineNumber_);
-         return true;
-      }
+   double *values[3]={x_value,y_value,z_value};
+   int k=0;
+   while (k < dim) {
+      char delimiter=',';
+      if (k == dim-1) delimiter=')';
+
+      size_t end=a.find(delimiter,i);
+      if (end == string_view::npos) {*position=a.size(); return PARSE_INVALID;}
+
+      size_t offset;
+      int result=parse_double(a.substr(i,end-i),values[k],&offset);
+      if (result != PARSE_OK) {*position=i+offset; return result;}
+
+      i=end+1;
+      k++;
    }
 
-   return false;
+   size_t trailing=a.find_first_not_of(" \t",i);
+   if (trailing != string_view::npos) {*position=trailing; return PARSE_INVALID;}
+
+   return PARSE_OK;
 }
 
-void get_token_pair (string *line, string *token, string *value, int *lineNumber, string indent) {
-   string test;
-   int count=0;
-
-   stringstream ss(*line);
-   while (getline(ss,test,'=')) {
-      if (count == 0) *token=test;
-      else if (count == 1) *value=test;
-      else {
-         prefix(); PetscPrintf(PETSC_COMM_WORLD,"%s%sERROR1003: Incorrectly formatted entry at line %d.\n",indent.c_str(),indent.c_str(),*lineNumber);
-      }
-      count++;
+bool point_get (string *a, double *x_value, double *y_value, double *z_value, int dim, string indent, int lineNumber_)
+{
+   size_t position;
+   if (parse_point(*a,dim,x_value,y_value,z_value,&position) == PARSE_OK) return false;
+
+   // the component with the error
+   long int commas=count(a->begin(),a->begin()+min(position,a->size()),',');
+   if (commas == 0) {prefix(); PetscPrintf(PETSC_COMM_WORLD,"%s%sERROR1000: %s value at line %d is invalid.\n",indent.c_str(),indent.c_str(),a->c_str(),lineNumber_);}
+   else if (commas == 1) {prefix(); PetscPrintf(PETSC_COMM_WORLD,"%s%sERROR1001: %s value at line %d is invalid.\n",indent.c_str(),indent.c_str(),a->c_str(),lineNumber_);}
+   else {prefix(); PetscPrintf(PETSC_COMM_WORLD,"%s%sERROR1002: %s value at line %d is invalid.\n",indent.c_str(),indent.c_str(),a->c_str(),lineNumber_);}
+
+   return true;
+}
+
+// Split line on the first '=' into a trimmed token and value that view into line.
+// Extra '=' separated pieces and a missing value are reported with the same messages as before.
+void split_token_pair (string_view line, string_view *token, string_view *value, int lineNumber, const char *indent) {
+
+   // count the pieces as getline on '=' would, where a trailing '=' does not start another piece
+   long unsigned int count=1;
+   size_t position=line.find('=');
+   size_t equal=position;
+   while (position != string_view::npos) {
+      if (position+1 < line.size()) count++;
+      position=line.find('=',position+1);
    }
 
-   if (count < 2) {prefix(); PetscPrintf(PETSC_COMM_WORLD,"%s%sERROR1004: Missing value at line %d.\n",indent.c_str(),indent.c_str(),*lineNumber);}
+   long unsigned int i=2;
+   while (i < count) {
+      prefix(); PetscPrintf(PETSC_COMM_WORLD,"%s%sERROR1003: Incorrectly formatted entry at line %d.\n",indent,indent,lineNumber);
+      i++;
+   }
+
+   if (count < 2) {prefix(); PetscPrintf(PETSC_COMM_WORLD,"%s%sERROR1004: Missing value at line %d.\n",indent,indent,lineNumber);}
+
+   *token=line.substr(0,equal);
+   *value=string_view();
+   if (count > 1) {
+      *value=line.substr(equal+1);
+      *value=value->substr(0,value->find('='));
+   }
 
    // chop off white space from front and back
 
-   size_t first=(*token).find_first_not_of(" \t");
-   size_t last=(*token).find_last_not_of(" \t");
-   *token=(*token).substr(first,last-first+1);
+   size_t first=token->find_first_not_of(" \t");
+   size_t last=token->find_last_not_of(" \t");
+   if (first == string_view::npos) *token=string_view();
+   else *token=token->substr(first,last-first+1);
 
-   if (value->length() > 0) {
-      first=(*value).find_first_not_of(" \t");
-      last=(*value).find_last_not_of(" \t");
-      *value=(*value).substr(first,last-first+1);
-   }
+   first=value->find_first_not_of(" \t");
+   last=value->find_last_not_of(" \t");
+   if (first == string_view::npos) *value=string_view();
+   else *value=value->substr(first,last-first+1);
+}
+
+void get_token_pair (string *line, string *token, string *value, int *lineNumber, string indent) {
+   string_view tokenView,valueView;
+   split_token_pair(*line,&tokenView,&valueView,*lineNumber,indent.c_str());
 
-   return;
+   string tokenText(tokenView),valueText(valueView);
+   *token=tokenText;
+   *value=valueText;
 }
 
 string processOutputNumber (double a)
@@ -383,74 +543,188 @@ bool processInputNumber (string a, double *b)
 {
    if (a.compare("NA") == 0) *b=DBL_MAX;
    else {
-      if (is_double(&a)) *b=stod(a);
-      else return true;
+      size_t position;
+      if (parse_double(a,b,&position) != PARSE_OK) return true;
    }
    return false;
 }
 
+// binary images, such as the materials cache, are built by appending raw values to a string
+// and read back by advancing a pointer through the image
+
+void image_put (string *image, const void *data, size_t length)
+{
+   image->append((const char *)data,length);
+}
+
+void image_put_string (string *image, string a)
+{
+   size_t length=a.size();
+   image_put(image,&length,sizeof(size_t));
+   image->append(a);
+}
+
+// return true on fail
+bool image_get (const char **position, const char *end, void *data, size_t length)
+{
+   if ((size_t)(end-*position) < length) return true;
+   memcpy(data,*position,length);
+   *position+=length;
+   return false;
+}
+
+// return true on fail
+bool image_get_string (const char **position, const char *end, string *a)
+{
+   size_t length;
+   if (image_get(position,end,&length,sizeof(size_t))) return true;
+   if ((size_t)(end-*position) < length) return true;
+   a->assign(*position,length);
+   *position+=length;
+   return false;
+}
+
+// broadcast the buffer read on rank 0, where fail is the outcome of the read on rank 0
+// return true on fail, on all ranks
+bool broadcast_buffer (string *buffer, bool fail, MPI_Comm comm)
+{
+   int rank;
+   MPI_Comm_rank(comm,&rank);
+
+   long long int size=-1;   // -1 for failure to read
+   if (rank == 0 && !fail) size=buffer->size();
+
+   MPI_Bcast(&size,1,MPI_LONG_LONG_INT,0,comm);
+   if (size < 0) {
+      if (rank != 0) buffer->clear();
+      return true;
+   }
+
+   if (rank != 0) buffer->resize(size);
+
+   // in pieces to keep the count within an int
+   long long int sent=0;
+   while (sent < size) {
+      int count=INT_MAX;
+      if (size-sent < count) count=size-sent;
+      MPI_Bcast(&((*buffer)[sent]),count,MPI_CHAR,0,comm);
+      sent+=count;
+   }
+
+   return false;
+}
+
 ///////////////////////////////////////////////////////////////////////////////////////////
 // inputFile
 ///////////////////////////////////////////////////////////////////////////////////////////
 
+// read the whole file into the buffer
 // return true on fail
-bool inputFile::load(const char *filename)
+bool inputFile::read(const char *filename)
 {
-   int lineNumber=0;
-   string line;
-
-   if (strcmp(filename,"") == 0) return true;
-
    ifstream materialFile;
-   materialFile.open(filename,ifstream::in);
+   materialFile.open(filename,ifstream::in|ifstream::binary);
 
-   if (materialFile.is_open()) {
+   if (! materialFile.is_open()) {
+      prefix(); PetscPrintf(PETSC_COMM_WORLD,"ERROR1005: File \"%s\" could not be opened for reading.\n",filename);
+      return true;
+   }
 
-      while (getline(materialFile,line)) {
-         lineNumber++;
+   materialFile.seekg(0,ios::end);
+   streamoff fileSize=materialFile.tellg();
+   materialFile.seekg(0,ios::beg);
+   if (fileSize > 0) {
+      buffer.resize(fileSize);
+      materialFile.read(&(buffer[0]),fileSize);
+      buffer.resize(materialFile.gcount());
+   } else {
+      buffer.clear();
+   }
 
-         // skip blank lines
-         if (line.compare("") != 0) {
+   return false;
+}
 
-            // skip comment lines
-            if (! is_comment(line)) {
+// rank 0 reads the file then broadcasts the outcome and the bytes so that only one rank opens it
+// return true on fail, on all ranks
+bool inputFile::read_collective(const char *filename)
+{
+   int rank;
+   MPI_Comm_rank(comm,&rank);
 
-               // chop off comments
-               line=line.substr(0,line.find("//",0));
+   bool fail=false;
+   if (rank == 0) fail=read(filename);
 
-               // chop off white space from front and back
-               size_t first=line.find_first_not_of(" \t");
-               size_t last=line.find_last_not_of(" \t");
+   return broadcast_buffer(&buffer,fail,comm);
+}
 
-               if (first <= last) {
-                  line=line.substr(first,last-first+1);
+// build the line tables from the buffer
+void inputFile::index()
+{
+   lineStartList.clear();
+   lineLengthList.clear();
+   lineNumberList.clear();
+   keywordIndex.clear();
 
-                  // save the line and the line number
-                  lineTextList.push_back(line);
-                  lineNumberList.push_back(lineNumber);
-               }
-            }
-         }
+   int lineNumber=0;
+   size_t position=0;
+   while (position < buffer.size()) {
+      size_t lineEnd=buffer.find('\n',position);
+      if (lineEnd == string::npos) lineEnd=buffer.size();
+      lineNumber++;
+
+      string_view line(buffer.data()+position,lineEnd-position);
+
+      // chop off comments, including whole comment lines
+      size_t comment=line.find("//");
+      if (comment != string_view::npos) line=line.substr(0,comment);
+
+      // chop off white space from front and back, skipping blank lines
+      size_t first=line.find_first_not_of(" \t");
+      if (first != string_view::npos) {
+         size_t last=line.find_last_not_of(" \t");
+
+         // save the line and the line number
+         lineStartList.push_back(position+first);
+         lineLengthList.push_back(last-first+1);
+         lineNumberList.push_back(lineNumber);
+
+         // index lines that can be block keywords for findBlock
+         line=line.substr(first,last-first+1);
+         if (line.find('=') == string_view::npos) keywordIndex[string(line)].push_back(lineNumberList.size()-1);
       }
+
+      position=lineEnd+1;
+   }
+
+   createCrossReference();
+}
+
+// With set_collective, this must be called on every rank of the communicator.
+// return true on fail
+bool inputFile::load(const char *filename)
+{
+   if (strcmp(filename,"") == 0) return true;
+
+   if (collective) {
+      if (read_collective(filename)) return true;
    } else {
-      prefix(); PetscPrintf(PETSC_COMM_WORLD,"ERROR1005: File \"%s\" could not be opened for reading.\n",filename);
-      return true;
+      if (read(filename)) return true;
    }
+
+   index();
+
    return false;
 }
 
+// load builds the cross reference, so calling this again is harmless
 void inputFile::createCrossReference()
 {
-   // initialize
-   long unsigned int max=lineNumberList[lineNumberList.size()-1];
-   long unsigned int i=0;
-   while (i <= max) {
-      crossReferenceList.push_back(-1);
-      i++;
-   }
+   crossReferenceList.clear();
+   if (lineNumberList.size() == 0) return;
 
-   // index
-   i=0;
+   crossReferenceList.resize(lineNumberList[lineNumberList.size()-1]+1,-1);
+
+   long unsigned int i=0;
    while (i < lineNumberList.size()) {
       crossReferenceList[lineNumberList[i]]=i;
       i++;
@@ -462,9 +736,9 @@ bool inputFile::checkVersion(string name, string version)
 {
    string line,token,value,test;
 
-   if (lineTextList.size() == 0) return true;
+   if (lineNumberList.size() == 0) return true;
 
-   line=lineTextList[0];
+   line=string(get_text(0));
 
    // chop off comments
    line=line.substr(0,line.find("//",0));
@@ -505,29 +779,50 @@ int inputFile::get_last_lineNumber() {
    return -1;
 }
 
+// index of the line at lineNumber, or -1 if the line was skipped or is out of range
+long int inputFile::get_index (int lineNumber) {
+   if (lineNumber < 0 || lineNumber >= (int)crossReferenceList.size()) return -1;
+   return crossReferenceList[lineNumber];
+}
+
+// a line number not found gives the first line
 int inputFile::get_previous_lineNumber (int lineNumber) {
-   long unsigned int i=lineNumberList.size()-1;
-   while (i > 0) {
-      if (lineNumberList[i] == lineNumber) return lineNumberList[i-1];
-      i--;
-   }
-   return lineNumberList[i];
+   if (lineNumberList.size() == 0) return -1;
+   long int i=get_index(lineNumber);
+   if (i > 0) return lineNumberList[i-1];
+   return lineNumberList[0];
 }
 
+// a line number not found gives the last line
 int inputFile::get_next_lineNumber (int lineNumber) {
-   long unsigned int i=0;
-   while (i < lineNumberList.size()-1) {
-      if (lineNumberList[i] == lineNumber) return lineNumberList[i+1];
-      i++;
-   }
-   return lineNumberList[i];
+   if (lineNumberList.size() == 0) return -1;
+   long int i=get_index(lineNumber);
+   if (i >= 0 && i+1 < (long int)lineNumberList.size()) return lineNumberList[i+1];
+   return lineNumberList[lineNumberList.size()-1];
 }
 
 string inputFile::get_line (int lineNumber) {
-   return lineTextList[crossReferenceList[lineNumber]];
+   return string(get_line_view(lineNumber));
+}
+
+// valid until the next load
+string_view inputFile::get_line_view (int lineNumber) {
+   return get_text(crossReferenceList[lineNumber]);
+}
+
+// index of the first line at or after index i that matches keyword, or get_size() if none
+long unsigned int inputFile::find_keyword (string keyword, long unsigned int i)
+{
+   unordered_map<string,vector<long unsigned int>>::iterator it=keywordIndex.find(keyword);
+   if (it == keywordIndex.end()) return lineNumberList.size();
+
+   vector<long unsigned int>::iterator found=lower_bound(it->second.begin(),it->second.end(),i);
+   if (found == it->second.end()) return lineNumberList.size();
+   return *found;
 }
 
 // find the starting and stopping line numbers for a block inclusive of the keywords
+// The keywords are looked up in keywordIndex, so only unmatched text reporting walks the lines.
 bool inputFile::findBlock(int search_startLine, int search_stopLine,
                          int *block_startLine, int *block_stopLine,
                          string initiator, string terminator, bool reportUnmatchedText)
@@ -536,32 +831,31 @@ bool inputFile::findBlock(int search_startLine, int search_stopLine,
    *block_startLine=-1;
    *block_stopLine=-1;
 
-   // skip to the search range
-   long unsigned int i=0;
-   while (i < lineNumberList.size()) {
-      if (lineNumberList[i] >= search_startLine) break;
-      i++;
-   }
+   // the search range is [i,stop)
+   long unsigned int i=lower_bound(lineNumberList.begin(),lineNumberList.end(),search_startLine)-lineNumberList.begin();
+   long unsigned int stop=upper_bound(lineNumberList.begin(),lineNumberList.end(),search_stopLine)-lineNumberList.begin();
 
    // find the start of the block
-   while (i < lineNumberList.size()) {
-      if (lineNumberList[i] <= search_stopLine) {
-         if (lineTextList[i].compare(initiator) == 0) {
-            *block_startLine=lineNumberList[i];
-            break;
-         } else if (lineTextList[i].compare(terminator) == 0) {
-            prefix(); PetscPrintf(PETSC_COMM_WORLD,"%s%sERROR1006: \"%s\" found at line %d is missing an opening \"%s\" keyword.\n",
-                                                   indent.c_str(),indent.c_str(),terminator.c_str(),lineNumberList[i],initiator.c_str());
-            *block_stopLine=lineNumberList[i];
-            return true;
-         } else {
-            if (reportUnmatchedText) {
-               prefix(); PetscPrintf(PETSC_COMM_WORLD,"%s%sERROR1007: Invalid entry at line %d.\n",indent.c_str(),indent.c_str(),lineNumberList[i] );
-               fail=true;
-            }
-         }
+   long unsigned int initiatorIndex=find_keyword(initiator,i);
+   long unsigned int terminatorIndex=find_keyword(terminator,i);
+   long unsigned int first=min(min(initiatorIndex,terminatorIndex),stop);
+
+   if (reportUnmatchedText) {
+      while (i < first) {
+         prefix(); PetscPrintf(PETSC_COMM_WORLD,"%s%sERROR1007: Invalid entry at line %d.\n",indent.c_str(),indent.c_str(),lineNumberList[i] );
+         fail=true;
+         i++;
       }
-      i++;
+   }
+
+   if (first < stop) {
+      if (first == terminatorIndex) {
+         prefix(); PetscPrintf(PETSC_COMM_WORLD,"%s%sERROR1006: \"%s\" found at line %d is missing an opening \"%s\" keyword.\n",
+                                                indent.c_str(),indent.c_str(),terminator.c_str(),lineNumberList[first],initiator.c_str());
+         *block_stopLine=lineNumberList[first];
+         return true;
+      }
+      *block_startLine=lineNumberList[first];
    }
    if (fail) return true;
 
@@ -572,25 +866,19 @@ bool inputFile::findBlock(int search_startLine, int search_stopLine,
    }
 
    // find the end of the block
-   i++;
-   while (i < lineNumberList.size()) {
-      if (lineNumberList[i] <= search_stopLine) {
-         if (lineTextList[i].compare(terminator) == 0) {
-            *block_stopLine=lineNumberList[i];
-            break;
-         }
-
-         // check for missing terminator
-         if (lineTextList[i].compare(initiator) == 0) {
-            prefix(); PetscPrintf(PETSC_COMM_WORLD,"%s%sERROR1008: \"%s\" block at line %d is incorrectly terminated at line %d.\n",
-                                                   indent.c_str(),indent.c_str(),initiator.c_str(),*block_startLine,lineNumberList[i]);
-            *block_stopLine=get_previous_lineNumber(lineNumberList[i]);
-            return true;
-         }
-      }
-      i++;
+   terminatorIndex=find_keyword(terminator,first+1);
+   initiatorIndex=find_keyword(initiator,first+1);
+
+   // check for missing terminator
+   if (initiatorIndex < terminatorIndex && initiatorIndex < stop) {
+      prefix(); PetscPrintf(PETSC_COMM_WORLD,"%s%sERROR1008: \"%s\" block at line %d is incorrectly terminated at line %d.\n",
+                                             indent.c_str(),indent.c_str(),initiator.c_str(),*block_startLine,lineNumberList[initiatorIndex]);
+      *block_stopLine=get_previous_lineNumber(lineNumberList[initiatorIndex]);
+      return true;
    }
 
+   if (terminatorIndex < stop) *block_stopLine=lineNumberList[terminatorIndex];
+
    // missing block terminator
    if (*block_stopLine < 0) {
       prefix(); PetscPrintf(PETSC_COMM_WORLD,"%s%sERROR1009: \"%s\" block at line %d is missing its terminator \"%s\".\n",
@@ -605,8 +893,8 @@ bool inputFile::findBlock(int search_startLine, int search_stopLine,
 void inputFile::print()
 {
    long unsigned int i=0;
-   while (i < lineTextList.size()) {
-      prefix(); PetscPrintf(PETSC_COMM_WORLD,"%d: %s\n",lineNumberList[i],lineTextList[i].c_str());
+   while (i < lineNumberList.size()) {
+      prefix(); PetscPrintf(PETSC_COMM_WORLD,"%d: %s\n",lineNumberList[i],string(get_text(i)).c_str());
       i++;
    }
 }
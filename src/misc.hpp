@@ -26,7 +26,15 @@
 #include <iostream>
 #include <sstream>
 #include <vector>
+#include <unordered_map>
+#include <algorithm>
+#include <cstring>
+#include <climits>
+#include <string_view>
+#include <charconv>
+#include <cerrno>
 #include <cfloat>
+#include <chrono>
 #include "petscsys.h"
 #include "prefix.h"
 
@@ -34,6 +42,11 @@ using namespace std;
 
 extern "C" void prefix ();
 
+// outcomes of the parse_ functions
+#define PARSE_OK 0
+#define PARSE_INVALID 1
+#define PARSE_OUT_OF_RANGE 2
+
 bool is_comment (string);
 bool is_hashComment (string);
 void split_on_space (vector<string> *, string);
@@ -46,18 +59,56 @@ bool is_complex (complex<double>);
 bool is_int (string *);
 bool is_point (string *, int);
 bool point_get (string *, double *, double *, double *, int, string, int);
+int parse_double (string_view, double *, size_t *);
+int parse_int (string_view, int *, size_t *);
+int parse_point (string_view, int, double *, double *, double *, size_t *);
+void split_token_pair (string_view, string_view *, string_view *, int, const char *);
 void get_token_pair (string *, string *, string *, int *, string);
 string processOutputNumber (double);
 bool processInputNumber (string, double *);
+void image_put (string *, const void *, size_t);
+void image_put_string (string *, string);
+bool image_get (const char **, const char *, void *, size_t);
+bool image_get_string (const char **, const char *, string *);
+bool broadcast_buffer (string *, bool, MPI_Comm);
+void test_tokenizer (long unsigned int);
 
+// Splits a line on white space into views of the line.  The token list is kept between calls,
+// so a tokenizer reused across the lines of a file stops allocating once the list has grown.
+// The views are only valid while the line is unchanged.
+class lineTokenizer
+{
+   private:
+      vector<string_view> tokens;
+   public:
+      long unsigned int split (string_view);
+      long unsigned int size () {return tokens.size();}
+      string_view get (long unsigned int i) {return tokens[i];}
+};
+
+// The file is held in one buffer with each kept line stored as an offset and length into it.
+// Lines are indexed in file order, and crossReferenceList maps a line number to its index
+// so that moving between lines is O(1).
 class inputFile
 {
    private:
-      vector<string> lineTextList;
+      string buffer;
+      vector<size_t> lineStartList;
+      vector<size_t> lineLengthList;
       vector<int> lineNumberList;
-      vector<int> crossReferenceList;   // for easy lookup
+      vector<int> crossReferenceList;   // index by line number, -1 for skipped lines
+      unordered_map<string,vector<long unsigned int>> keywordIndex;   // sorted indexes of the lines without "=", such as block keywords
       string indent="   ";
+      bool collective=false;            // rank 0 reads the file and broadcasts it on comm
+      MPI_Comm comm;
+      bool read (const char *);
+      bool read_collective (const char *);
+      void index ();
+      long unsigned int find_keyword (string, long unsigned int);
    public:
+      void set_collective (MPI_Comm comm_) {collective=true; comm=comm_;}
+      bool is_collective () {return collective;}
+      MPI_Comm get_comm () {return comm;}
       bool load (const char *);
       void createCrossReference ();
       bool checkVersion (string, string);
@@ -70,6 +121,15 @@ class inputFile
       int get_previous_lineNumber (int);
       int get_next_lineNumber (int);
       string get_line (int);
+      string_view get_line_view (int);
+      string_view get_text (long unsigned int i) {return string_view(buffer.data()+lineStartList[i],lineLengthList[i]);}
+      long int get_index (int);
+
+      // block iteration by index, exclusive of the lines holding the block keywords:
+      //    long unsigned int i=inputs->block_begin(startLine);
+      //    while (i < inputs->block_end(endLine)) {... get_lineNumber(i), get_text(i) ...; i++;}
+      long unsigned int block_begin (int startLine) {return get_index(startLine)+1;}
+      long unsigned int block_end (int endLine) {return get_index(endLine);}
 };
 
 #endif
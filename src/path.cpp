@@ -470,11 +470,11 @@ bool mergePaths (vector<Path *> *pathList, vector<long unsigned int> *pathIndexL
          long unsigned int j=path->get_points_size()-1;
          while (j >= 0) {
             // always add the point to a new path
-            if ((*mergedPath)->get_points_size() == 0) (*mergedPath)->push_point(path->get_point(j)->clone());           
+            if ((*mergedPath)->get_points_size() == 0) (*mergedPath)->push_point(path->get_point_value(j),path->get_point_lineNumber(j));
             else {
                 // add if the point does not duplicate the last one
-                if (! point_comparison(path->get_point(j)->get_point_value(),(*mergedPath)->get_point((*mergedPath)->get_points_size()-1)->get_point_value(),tol)) {
-                    (*mergedPath)->push_point(path->get_point(j)->clone());
+                if (! point_comparison(path->get_point_value(j),(*mergedPath)->get_point_value((*mergedPath)->get_points_size()-1),tol)) {
+                    (*mergedPath)->push_point(path->get_point_value(j),path->get_point_lineNumber(j));
                 }
             }
             if (j == 0) break;
@@ -484,11 +484,11 @@ bool mergePaths (vector<Path *> *pathList, vector<long unsigned int> *pathIndexL
          long unsigned int j=0;
          while (j < path->get_points_size()) {
             // always add the point to a new path
-            if ((*mergedPath)->get_points_size() == 0) (*mergedPath)->push_point(path->get_point(j)->clone());
+            if ((*mergedPath)->get_points_size() == 0) (*mergedPath)->push_point(path->get_point_value(j),path->get_point_lineNumber(j));
             else {
                 // add if the point does not duplicate the last one
-                if (! point_comparison(path->get_point(j)->get_point_value(),(*mergedPath)->get_point((*mergedPath)->get_points_size()-1)->get_point_value(),tol)) {
-                    (*mergedPath)->push_point(path->get_point(j)->clone());
+                if (! point_comparison(path->get_point_value(j),(*mergedPath)->get_point_value((*mergedPath)->get_points_size()-1),tol)) {
+                    (*mergedPath)->push_point(path->get_point_value(j),path->get_point_lineNumber(j));
                 }
             }
             j++;
@@ -498,7 +498,7 @@ bool mergePaths (vector<Path *> *pathList, vector<long unsigned int> *pathIndexL
       i++;
    }
    // check for closed polygon
-   if (point_comparison((*mergedPath)->get_point(0)->get_point_value(),(*mergedPath)->get_point((*mergedPath)->get_points_size()-1)->get_point_value(),tol)) {
+   if (point_comparison((*mergedPath)->get_point_value(0),(*mergedPath)->get_point_value((*mergedPath)->get_points_size()-1),tol)) {
       (*mergedPath)->pop_point();
    }
 
@@ -509,8 +509,8 @@ bool mergePaths (vector<Path *> *pathList, vector<long unsigned int> *pathIndexL
    while (i < (*mergedPath)->get_points_size()-1) {
       long unsigned int j=i+1;
       while (j < (*mergedPath)->get_points_size()) {
-         if (point_comparison((*mergedPath)->get_point(i)->get_point_value(),(*mergedPath)->get_point(j)->get_point_value(),tol)) {
-            struct point p=(*mergedPath)->get_point(i)->get_point_value();
+         if (point_comparison((*mergedPath)->get_point_value(i),(*mergedPath)->get_point_value(j),tol)) {
+            struct point p=(*mergedPath)->get_point_value(i);
             prefix(); PetscPrintf(PETSC_COMM_WORLD,"ERROR1096: Merged path for %s %s has duplicate point at (%g,%g,%g)\n",
                boundaryType.c_str(),boundaryName.c_str(),p.x,p.y,p.z);
             fail=true;
@@ -539,28 +539,22 @@ bool mergePaths (vector<Path *> *pathList, vector<long unsigned int> *pathIndexL
 // Path
 ///////////////////////////////////////////////////////////////////////////////////////////
 
+// keywords shared by all Path blocks, indexed by PATH_NAME, PATH_CLOSED and PATH_POINT
+static constexpr keywordSchema pathSchema[]={
+   {{"name"},0,0,false,false},
+   {{"closed"},0,0,false,false},
+   {{"point"},-100,100,false,false}
+};
+static constexpr keywordDispatch<3> pathDispatch(pathSchema);
+static_assert(pathDispatch.is_perfect(),"Path keyword aliases need a larger dispatch table.");
+
 Path::Path(int startLine_, int endLine_)
 {
    startLine=startLine_;
    endLine=endLine_;
 
-   // name
-   name.push_alias("name");
-   name.set_loaded(false);
-   name.set_positive_required(false);
-   name.set_non_negative_required(false);
-   name.set_lowerLimit(0);
-   name.set_upperLimit(0);
-   name.set_checkLimits(false);
-
-   // closed
-   closed.push_alias("closed");
-   closed.set_loaded(false);
-   closed.set_positive_required(false);
-   closed.set_non_negative_required(false);
-   closed.set_lowerLimit(0);
-   closed.set_upperLimit(0);
-   closed.set_checkLimits(false);
+   name.set_schema(&pathSchema[PATH_NAME],false);
+   closed.set_schema(&pathSchema[PATH_CLOSED],false);
 
    rotated=false;
 
@@ -583,19 +577,59 @@ struct point Path::get_point_value (long unsigned int i)
    struct point error;
    error.dim=3; error.x=-DBL_MAX; error.y=-DBL_MAX; error.z=-DBL_MAX;
 
-   if (i < points.size()) return points[i]->get_point_value();
-   if (points.size() > 0 && is_closed() && i == points.size()) return points[0]->get_point_value();
+   if (i < xList.size()) return point_at(i);
+   if (xList.size() > 0 && is_closed() && i == xList.size()) return point_at(0);
 
    return error;
 }
 
+void Path::push_point (struct point p, int lineNumber)
+{
+   kernel.valid=false;
+   pointDim=p.dim;
+   xList.push_back(p.x);
+   yList.push_back(p.y);
+   zList.push_back(p.z);
+   lineNumberList.push_back(lineNumber);
+}
+
+// takes ownership of point, as the path did when it held keywordPairs
+void Path::push_point (keywordPair *point)
+{
+   push_point(point->get_point_value(),point->get_lineNumber());
+   delete point;
+}
+
+const keywordPair* Path::point_pair (long unsigned int i)
+{
+   // a deque keeps the earlier keywordPairs in place as it grows, and it is not shrunk after pop_point
+   // so that pointers handed out earlier stay valid
+   while (pointPairList.size() < xList.size()) pointPairList.emplace_back();
+
+   keywordPair *pair=&pointPairList[i];
+   pair->set_schema(&pathSchema[PATH_POINT],true);
+   pair->set_point_value(point_at(i));
+   pair->set_lineNumber(lineNumberList[i]);
+   pair->set_loaded(true);
+   return pair;
+}
+
+void Path::pop_point ()
+{
+   kernel.valid=false;
+   xList.pop_back();
+   yList.pop_back();
+   zList.pop_back();
+   lineNumberList.pop_back();
+}
+
 void Path::offset (struct point delp)
 {
    long unsigned int i=0;
-   while (i < points.size()) {
-      struct point p=points[i]->get_point_value();
+   while (i < xList.size()) {
+      struct point p=point_at(i);
       p=point_addition(p,delp);
-      points[i]->set_point_value(p);
+      set_point(i,p);
       i++;
    }
 }
@@ -603,7 +637,7 @@ void Path::offset (struct point delp)
 // return true if the point is close
 bool Path::compare (long unsigned int i, keywordPair test_point)
 {
-   struct point a=points[i]->get_point_value();
+   struct point a=point_at(i);
    struct point b=test_point.get_point_value();
    return point_comparison(a,b,tol);
 }
@@ -614,8 +648,8 @@ void Path::print (string indent)
    prefix(); PetscPrintf(PETSC_COMM_WORLD,"%sPath %p\n",indent.c_str(),this);
    prefix(); PetscPrintf(PETSC_COMM_WORLD,"%s   name=%s\n",indent.c_str(),get_name().c_str());
    long unsigned int i=0;
-   while (i < points.size()) {
-      struct point p=points[i]->get_point_value();
+   while (i < xList.size()) {
+      struct point p=point_at(i);
       if (p.dim == 2) {dim=2; prefix(); PetscPrintf(PETSC_COMM_WORLD,"%s   point=(%g,%g)\n",indent.c_str(),p.x,p.y);}
       if (get_point_dim(i) == 3) {dim=3; prefix(); PetscPrintf(PETSC_COMM_WORLD,"%s   point=(%g,%g,%g)\n",indent.c_str(),p.x,p.y,p.z);}
       i++;
@@ -654,8 +688,8 @@ bool Path::output (ofstream *out, int force_dim)
    *out << "Path" << endl;
    *out << "   name=" << get_name() << endl;
    long unsigned int i=0;
-   while (i < points.size()) {
-      struct point p=points[i]->get_point_value();
+   while (i < xList.size()) {
+      struct point p=point_at(i);
       if (force_dim == 2) {*out << setprecision(16) << "   point=(" << p.x << "," << p.y << ")" << endl;}
       if (force_dim == 3) {*out << setprecision(16) << "   point=(" << p.x << "," << p.y << "," << p.z << ")" << endl;}
       i++;
@@ -678,13 +712,13 @@ bool Path::load(int dim, string *indent, inputFile *inputs)
    int stopLineNumber=inputs->get_previous_lineNumber(endLine);
    while (lineNumber <= stopLineNumber) {
 
-      string token,value,line;
-      line=inputs->get_line(lineNumber);
-      get_token_pair(&line,&token,&value,&lineNumber,*indent);
+      string_view token,value;
+      split_token_pair(inputs->get_line_view(lineNumber),&token,&value,lineNumber,indent->c_str());
 
       int recognized=0;
+      int slot=pathDispatch.find(token);
 
-      if (name.match_alias(&token)) {
+      if (slot == PATH_NAME) {
          if (name.is_loaded()) {
             prefix(); PetscPrintf(PETSC_COMM_WORLD,"%s%sERROR1097: Duplicate entry at line %d for previous entry at line %d.\n",
                                                   indent->c_str(),indent->c_str(),lineNumber,name.get_lineNumber());
@@ -698,29 +732,19 @@ bool Path::load(int dim, string *indent, inputFile *inputs)
          recognized++;
       }
 
-      if (token.compare("point") == 0) {
-         keywordPair *point=new keywordPair;
-         point->push_alias("point");
-         point->set_keyword(token);
-         point->set_value(value);
-         point->set_lineNumber(lineNumber);
-         point->set_positive_required(false);
-         point->set_non_negative_required(false);
-         point->set_lowerLimit(-100);
-         point->set_upperLimit(100);
-         point->set_checkLimits(true);
-         point->set_loaded(false);
-         point->set_point_value(-DBL_MAX,-DBL_MAX,-DBL_MAX);
-
-         if (point->loadPoint(dim,&token,&value,lineNumber)) delete point;
-         else points.push_back(point);
+      if (slot == PATH_POINT) {
+         keywordPair point;
+         point.set_schema(&pathSchema[PATH_POINT],true);
+         point.set_point_value(-DBL_MAX,-DBL_MAX,-DBL_MAX);
+
+         if (!point.loadPoint(dim,token,value,lineNumber)) push_point(point.get_point_value(),lineNumber);
 
          recognized++;
       }
 
-      if (closed.match_alias(&token)) {
+      if (slot == PATH_CLOSED) {
          recognized++;
-         if (closed.loadBool(&token, &value, lineNumber)) fail=true;
+         if (closed.loadBool(token, value, lineNumber)) fail=true;
       }
 
       // should recognize one keyword
@@ -742,11 +766,11 @@ bool Path::checkBoundingBox(Vector *lowerLeft, Vector *upperRight, string *inden
    bool fail=false;
 
    long unsigned int i=0;
-   while (i < points.size()) {
+   while (i < xList.size()) {
 
       bool point_fail=false;
 
-      struct point p=points[i]->get_point_value();
+      struct point p=point_at(i);
 
       if (p.x < lowerLeft->Elem(0)-tol) point_fail=true;
       if (p.x > upperRight->Elem(0)+tol) point_fail=true;
@@ -797,17 +821,17 @@ bool Path::check(string *indent)
       fail=true;
    }
 
-   if (points.size() == 0) {
+   if (xList.size() == 0) {
       prefix(); PetscPrintf(PETSC_COMM_WORLD,"%s%sERROR1103: Path block at line %d must specify points.\n",indent->c_str(),indent->c_str(),startLine);
       fail=true;
    }
 
-   if (points.size() == 1) {
+   if (xList.size() == 1) {
       prefix(); PetscPrintf(PETSC_COMM_WORLD,"%s%sERROR1104: Path block at line %d must specify more than one point.\n",indent->c_str(),indent->c_str(),startLine);
       fail=true;
    }
 
-   if (points.size() == 2 && closed.get_bool_value()) {
+   if (xList.size() == 2 && closed.get_bool_value()) {
       prefix(); PetscPrintf(PETSC_COMM_WORLD,"%s%sERROR1105: Path block at line %d cannot be closed with just two points.\n",indent->c_str(),indent->c_str(),startLine);
       fail=true;
    }
@@ -819,15 +843,15 @@ bool Path::check(string *indent)
 long unsigned int Path::is_segmentOnLine (struct point pt1, struct point pt2)
 {
    long unsigned int i=0;
-   while (points.size() > 0 && i < points.size()-1) {
-      if (is_point_on_line(pt1,points[i]->get_point_value(),points[i+1]->get_point_value(),1e-8) &&
-          is_point_on_line(pt2,points[i]->get_point_value(),points[i+1]->get_point_value(),1e-8)) return i;
+   while (xList.size() > 0 && i < xList.size()-1) {
+      if (is_point_on_line(pt1,point_at(i),point_at(i+1),1e-8) &&
+          is_point_on_line(pt2,point_at(i),point_at(i+1),1e-8)) return i;
       i++;
    }
 
    if (is_closed()) {
-      if (is_point_on_line(pt1,points[points.size()-1]->get_point_value(),points[0]->get_point_value(),1e-8) &&
-          is_point_on_line(pt2,points[points.size()-1]->get_point_value(),points[0]->get_point_value(),1e-8)) return points.size()-1;
+      if (is_point_on_line(pt1,point_at(xList.size()-1),point_at(0),1e-8) &&
+          is_point_on_line(pt2,point_at(xList.size()-1),point_at(0),1e-8)) return xList.size()-1;
    }
 
    long unsigned int max=-1;
@@ -838,12 +862,12 @@ double Path::sum_of_angles (struct point pt)
 {
    double theta1=0;
    long unsigned int i=0;
-   while (i < points.size()-1) {
-      theta1+=signed_angle_between_two_lines (pt,points[i]->get_point_value(),points[i+1]->get_point_value(),normal);
+   while (i < xList.size()-1) {
+      theta1+=signed_angle_between_two_lines (pt,point_at(i),point_at(i+1),normal);
       i++;
    }
    if (is_closed()) {
-      theta1+=signed_angle_between_two_lines (pt,points[i]->get_point_value(),points[0]->get_point_value(),normal);
+      theta1+=signed_angle_between_two_lines (pt,point_at(i),point_at(0),normal);
    }
    return theta1;
 }
@@ -853,54 +877,55 @@ double Path::sum_of_angles (struct point pt)
 void Path::subdivide (Path *test)
 {
    bool modified=false;
-   vector<keywordPair *> newPoints;
+   Path subdivided(startLine,endLine);
 
-   if (points.size() == 0) return;
-   if (test->points.size() == 0) return;
+   if (xList.size() == 0) return;
+   if (test->xList.size() == 0) return;
 
-   newPoints.push_back(test->points[0]->clone());
+   subdivided.push_point(test->point_at(0),test->lineNumberList[0]);
 
    long unsigned int i=0;
-   while (i < points.size()-1) {
+   while (i < xList.size()-1) {
 
       long unsigned int j=0;
-      while (j < test->points.size()-1) {
+      while (j < test->xList.size()-1) {
 
          bool break_on_1=false;
          bool break_on_2=false;
 
-         bool parallel=are_parallel (test->points[j]->get_point_value(),test->points[j+1]->get_point_value(),
-                                     points[i]->get_point_value(),points[i+1]->get_point_value(),1e-12);
+         bool parallel=are_parallel (test->point_at(j),test->point_at(j+1),
+                                     point_at(i),point_at(i+1),1e-12);
 
-         if (parallel && is_point_on_line_not_ends(test->points[j]->get_point_value(),points[i]->get_point_value(),points[i+1]->get_point_value(),1e-8)) break_on_1=true;
-         if (parallel && is_point_on_line_not_ends(test->points[j+1]->get_point_value(),points[i]->get_point_value(),points[i+1]->get_point_value(),1e-8)) break_on_2=true;
+         if (parallel && is_point_on_line_not_ends(test->point_at(j),point_at(i),point_at(i+1),1e-8)) break_on_1=true;
+         if (parallel && is_point_on_line_not_ends(test->point_at(j+1),point_at(i),point_at(i+1),1e-8)) break_on_2=true;
 
          if (break_on_1) {
             if (break_on_2) {
                // segment is fully enclosed
 
                // maintain ordering along the line
-               if (points[i]->get_point_distance(test->points[j]) < points[i]->get_point_distance(test->points[j+1])) {
-                  if (! points[points.size()-1]->is_close_point (test->points[j])) {
-                     newPoints.push_back(test->points[j]->clone());
+               struct point p=point_at(i);
+               if (point_magnitude(point_subtraction(p,test->point_at(j))) < point_magnitude(point_subtraction(p,test->point_at(j+1)))) {
+                  if (! point_comparison(point_at(xList.size()-1),test->point_at(j),1e-12)) {
+                     subdivided.push_point(test->point_at(j),test->lineNumberList[j]);
                   }
-                  newPoints.push_back(test->points[j+1]->clone());
+                  subdivided.push_point(test->point_at(j+1),test->lineNumberList[j+1]);
                } else {
-                  if (! points[points.size()-1]->is_close_point (test->points[j+1])) {
-                     newPoints.push_back(test->points[j+1]->clone());
+                  if (! point_comparison(point_at(xList.size()-1),test->point_at(j+1),1e-12)) {
+                     subdivided.push_point(test->point_at(j+1),test->lineNumberList[j+1]);
                   }
-                  newPoints.push_back(test->points[j]->clone());
+                  subdivided.push_point(test->point_at(j),test->lineNumberList[j]);
                }
                modified=true;
             } else {
                // partial overlap - break the segment at test point 1
-               newPoints.push_back(test->points[j]->clone());
+               subdivided.push_point(test->point_at(j),test->lineNumberList[j]);
                modified=true;
             }
          } else {
             if (break_on_2) {
                // partial overlap - break the segment at test point 2
-               newPoints.push_back(test->points[j+1]->clone());
+               subdivided.push_point(test->point_at(j+1),test->lineNumberList[j+1]);
                modified=true;
             } else {
                // nothing to do
@@ -911,30 +936,17 @@ void Path::subdivide (Path *test)
       }
 
       // finish the segment
-      newPoints.push_back(points[i+1]->clone());
+      subdivided.push_point(point_at(i+1),lineNumberList[i+1]);
 
       i++;
    }
 
    if (modified) {
-      long unsigned int k=0;
-      while (k < points.size()) {
-         delete points[k];
-         k++;
-      }
-      points.clear();
-
-      k=0;
-      while (k < newPoints.size()) {
-         points.push_back(newPoints[k]);
-         k++;
-      }
-   } else {
-      long unsigned int k=0;
-      while (k < newPoints.size()) {
-         delete newPoints[k];
-         k++;
-      }
+      kernel.valid=false;
+      xList.swap(subdivided.xList);
+      yList.swap(subdivided.yList);
+      zList.swap(subdivided.zList);
+      lineNumberList.swap(subdivided.lineNumberList);
    }
 }
 
@@ -960,11 +972,11 @@ Path* Path::clone()
    newPath->hasNormal=hasNormal;
    newPath->normal=point_copy(normal);;
 
-   long unsigned int i=0;
-   while (i < points.size()) {
-      newPath->points.push_back(points[i]->clone());
-      i++;
-   }
+   newPath->pointDim=pointDim;
+   newPath->xList=xList;
+   newPath->yList=yList;
+   newPath->zList=zList;
+   newPath->lineNumberList=lineNumberList;
 
    newPath->hasOutput=hasOutput;
 
@@ -980,8 +992,8 @@ void Path::calculateBoundingBox()
    zmax=-DBL_MAX;
    zmin=DBL_MAX;
    long unsigned int i=0;
-   while (i < points.size()) {
-      struct point p=points[i]->get_point_value();
+   while (i < xList.size()) {
+      struct point p=point_at(i);
       if (p.x > xmax) xmax=p.x;
       if (p.x < xmin) xmin=p.x;
       if (p.y > ymax) ymax=p.y;
@@ -996,10 +1008,11 @@ void Path::calculateBoundingBox()
 // assumes that the path is planar
 bool Path::calculateNormal ()
 {
-   if (points.size() == 0) return true;
+   kernel.valid=false;
+   if (xList.size() == 0) return true;
 
    // exit if 0, 1, or 2 points - cannot determine a normal vector
-   if (points.size() < 3) {
+   if (xList.size() < 3) {
       //prefix(); PetscPrintf(PETSC_COMM_WORLD,"ASSERT: Path::calculateNormal passed path with fewer than 3 points.\n");
       return true;
    }
@@ -1009,19 +1022,19 @@ bool Path::calculateNormal ()
    double smallest_difference=1e30;
    long unsigned int index=0;
    long unsigned int i=1;
-   while (i < points.size()-1) {
-      theta1=angle_between_two_lines(points[i]->get_point_value(),points[i-1]->get_point_value(),points[i+1]->get_point_value());
+   while (i < xList.size()-1) {
+      theta1=angle_between_two_lines(point_at(i),point_at(i-1),point_at(i+1));
       if (abs(abs(theta1)-M_PI/2) < smallest_difference) {smallest_difference=abs(abs(theta1)-M_PI/2); index=i;}
       i++;
    }
 
    if (is_closed()) {
       i=0;
-      theta1=angle_between_two_lines (points[i]->get_point_value(),points[points.size()-1]->get_point_value(),points[i+1]->get_point_value());
+      theta1=angle_between_two_lines (point_at(i),point_at(xList.size()-1),point_at(i+1));
       if (abs(abs(theta1)-M_PI/2) < smallest_difference) {smallest_difference=abs(abs(theta1)-M_PI/2); index=i;}
 
-      i=points.size()-1;
-      theta1=angle_between_two_lines (points[i]->get_point_value(),points[i-1]->get_point_value(),points[0]->get_point_value());
+      i=xList.size()-1;
+      theta1=angle_between_two_lines (point_at(i),point_at(i-1),point_at(0));
       if (abs(abs(theta1)-M_PI/2) < smallest_difference) {smallest_difference=abs(abs(theta1)-M_PI/2); index=i;}
    }
 
@@ -1035,17 +1048,17 @@ bool Path::calculateNormal ()
 
    struct point pt1,ptc,pt2;
    if (index == 0) {
-      pt1=points[points.size()-1]->get_point_value();
-      ptc=points[0]->get_point_value();
-      pt2=points[index+1]->get_point_value();
-   } else if (index == points.size()-1) {
-      pt1=points[points.size()-2]->get_point_value();
-      ptc=points[points.size()-1]->get_point_value();
-      pt2=points[0]->get_point_value();
+      pt1=point_at(xList.size()-1);
+      ptc=point_at(0);
+      pt2=point_at(index+1);
+   } else if (index == xList.size()-1) {
+      pt1=point_at(xList.size()-2);
+      ptc=point_at(xList.size()-1);
+      pt2=point_at(0);
    } else {
-      pt1=points[index-1]->get_point_value();
-      ptc=points[index]->get_point_value();
-      pt2=points[index+1]->get_point_value();
+      pt1=point_at(index-1);
+      ptc=point_at(index);
+      pt2=point_at(index+1);
    }
 
    pt1=point_subtraction(pt1,ptc);
@@ -1091,17 +1104,17 @@ Path* Path::rotateToXYplane ()
    rotated->sin_phi_=sin(rotated->phi);
 
    long unsigned int i=0;
-   while (i < rotated->points.size()) {
-      struct point p=rotated->points[i]->get_point_value();
+   while (i < rotated->xList.size()) {
+      struct point p=rotated->point_at(i);
       rotated->rotatePoint(&p);
-      rotated->points[i]->set_point_value(p);
+      rotated->set_point(i,p);
       i++;
    }
 
    // check that the path is planar - all z components should be close
    i=1;
-   while (i < rotated->points.size()) {
-      if (! double_compare(rotated->points[i]->get_point_value().z,rotated->points[0]->get_point_value().z,rotated->tol)) {
+   while (i < rotated->xList.size()) {
+      if (! double_compare(rotated->point_at(i).z,rotated->point_at(0).z,rotated->tol)) {
          prefix(); PetscPrintf(PETSC_COMM_WORLD,"ASSERT: Path::rotateToXYplane passed a 3D path that is not planar.\n");
       }
       i++;
@@ -1190,10 +1203,10 @@ void Path::rotateToPath (Path *rotatedPath)
    if (rotated) return;
 
    long unsigned int i=0;
-   while (i < points.size()) {
+   while (i < xList.size()) {
       struct point p=get_point_value(i);
       rotatedPath->rotatePoint(&p);
-      points[i]->set_point_value(p);
+      set_point(i,p);
       i++;
    }
 
@@ -1215,10 +1228,10 @@ void Path::rotateToPath (Path *rotatedPath, bool spin180degrees)
    if (rotated) return;
 
    long unsigned int i=0;
-   while (i < points.size()) {
-      struct point p=points[i]->get_point_value();
+   while (i < xList.size()) {
+      struct point p=point_at(i);
       rotatedPath->rotatePoint(&p,spin180degrees);
-      points[i]->set_point_value(p);
+      set_point(i,p);
       i++;
    }
 
@@ -1229,22 +1242,256 @@ void Path::rotateToPath (Path *rotatedPath, bool spin180degrees)
    return;
 }
 
-// define interior as NOT including the lines themselves
-bool Path::is_point_interior (struct point p1)
+// Edge bins along axisB for every path, plus the plane and projection for a closed 3D path.
+// For the interior test, tetrahedra_volume(a,p[i],p[i+1],p[i+2]) is dot(p[i]-a,n[i])/6 with
+// n[i]=(p[i+1]-p[i])x(p[i+2]-p[i]).  Writing a-center as d*u plus an in-plane part of length tp,
+// each volume is within (maxW+tp*maxE)/6 of -d*dot(u,n[i])/6, so all of the volumes can be bounded
+// from d and tp alone.
+void Path::build_kernel ()
 {
-   if (points.size() < 2) return false;
+   kernel.valid=true;
+   kernel.usable=false;
+   kernel.axisA=0;
+   kernel.axisB=1;
+   kernel.binStart.clear();
+   kernel.binEdges.clear();
+   kernel.radius=0;
+   kernel.planeTol=tol;
+
+   long unsigned int n=xList.size();
+   if (n == 0) return;
+
+   const double *c[3]={xList.data(),yList.data(),zList.data()};
+
+   if (pointDim == 3) {
+
+      int m=0;
+      while (m < 3) {
+         kernel.center[m]=0;
+         long unsigned int i=0;
+         while (i < n) {kernel.center[m]+=c[m][i]; i++;}
+         kernel.center[m]/=n;
+         m++;
+      }
 
-   if (is_point_on_path(p1)) return false;
+      long unsigned int i=0;
+      while (i < n) {
+         double dx=c[0][i]-kernel.center[0],dy=c[1][i]-kernel.center[1],dz=c[2][i]-kernel.center[2];
+         kernel.radius=max(kernel.radius,sqrt(dx*dx+dy*dy+dz*dz));
+         i++;
+      }
 
-   if (rotated) rotatePoint(&p1);
+      // volumes scale with the cube of the size, and paths of unit size or smaller keep tol
+      kernel.planeTol=tol*pow(max(1.0,kernel.radius),3);
+
+      // Newell's normal picks the projection that best keeps the shape of the path
+      double N[3]={0,0,0};
+      i=0;
+      while (i < n) {
+         long unsigned int j=(i+1)%n;
+         N[0]+=(c[1][i]-c[1][j])*(c[2][i]+c[2][j]);
+         N[1]+=(c[2][i]-c[2][j])*(c[0][i]+c[0][j]);
+         N[2]+=(c[0][i]-c[0][j])*(c[1][i]+c[1][j]);
+         i++;
+      }
+
+      int k=2;
+      if (fabs(N[0]) >= fabs(N[1]) && fabs(N[0]) >= fabs(N[2])) k=0;
+      else if (fabs(N[1]) >= fabs(N[2])) k=1;
+      kernel.axisA=(k+1)%3;
+      kernel.axisB=(k+2)%3;
+
+      double length=sqrt(N[0]*N[0]+N[1]*N[1]+N[2]*N[2]);
+      if (is_closed() && n >= 3 && hasNormal && length > 0) {
+         m=0;
+         while (m < 3) {
+            kernel.u[m]=N[m]/length;
+            m++;
+         }
+
+         kernel.maxW=0; kernel.maxS=0; kernel.maxE=0; kernel.maxN=0;
+         i=0;
+         while (i < n-2) {
+            struct point p=point_at(i);
+            struct point nv=point_cross_product(point_subtraction(point_at(i+1),p),point_subtraction(point_at(i+2),p));
+            double w=(p.x-kernel.center[0])*nv.x+(p.y-kernel.center[1])*nv.y+(p.z-kernel.center[2])*nv.z;
+            double sigma=kernel.u[0]*nv.x+kernel.u[1]*nv.y+kernel.u[2]*nv.z;
+            double ex=nv.x-sigma*kernel.u[0],ey=nv.y-sigma*kernel.u[1],ez=nv.z-sigma*kernel.u[2];
+            kernel.maxW=max(kernel.maxW,fabs(w));
+            kernel.maxS=max(kernel.maxS,fabs(sigma));
+            kernel.maxE=max(kernel.maxE,sqrt(ex*ex+ey*ey+ez*ez));
+            kernel.maxN=max(kernel.maxN,point_magnitude(nv));
+            i++;
+         }
+
+         // the angle sum is taken about the path normal, so it must not lie in the plane
+         double alignment=kernel.u[0]*normal.x+kernel.u[1]*normal.y+kernel.u[2]*normal.z;
+         kernel.usable=(fabs(alignment) > 0.5);
+      }
+   }
+
+   // edge i runs from point i to point i+1, wrapping for closed paths
+   long unsigned int edgeCount=n-1;
+   if (is_closed()) edgeCount=n;
+   if (edgeCount == 0) return;
+
+   // pad so that every edge that is_point_on_line can accept is a candidate
+   const double *b=c[kernel.axisB];
+   double low=DBL_MAX,high=-DBL_MAX,maxAbs=0;
+   long unsigned int i=0;
+   while (i < n) {
+      low=min(low,b[i]);
+      high=max(high,b[i]);
+      maxAbs=max(maxAbs,fabs(b[i]));
+      i++;
+   }
+   double pad=2*tol*(1+maxAbs);
+   low-=pad;
+   high+=pad;
+
+   long unsigned int binCount=1;
+   if (edgeCount >= 32) binCount=edgeCount/4;
+   kernel.binLow=low;
+   kernel.binScale=0;
+   if (high > low) kernel.binScale=binCount/(high-low);
+
+   // counting sort of the edges into the bins they span
+   vector<long unsigned int> first(edgeCount),last(edgeCount);
+   kernel.binStart.assign(binCount+1,0);
+   i=0;
+   while (i < edgeCount) {
+      long unsigned int j=(i+1)%n;
+      double bmin=min(b[i],b[j])-pad,bmax=max(b[i],b[j])+pad;
+      first[i]=min(binCount-1,(long unsigned int)max(0.0,floor((bmin-low)*kernel.binScale)));
+      last[i]=min(binCount-1,(long unsigned int)max(0.0,floor((bmax-low)*kernel.binScale)));
+      long unsigned int k=first[i];
+      while (k <= last[i]) {kernel.binStart[k+1]++; k++;}
+      i++;
+   }
+
+   i=0;
+   while (i < binCount) {kernel.binStart[i+1]+=kernel.binStart[i]; i++;}
+
+   kernel.binEdges.resize(kernel.binStart[binCount]);
+   vector<long unsigned int> fill(kernel.binStart.begin(),kernel.binStart.end()-1);
+   i=0;
+   while (i < edgeCount) {
+      long unsigned int k=first[i];
+      while (k <= last[i]) {kernel.binEdges[fill[k]]=i; fill[k]++; k++;}
+      i++;
+   }
+}
+
+// signed distance d from the plane, squared distance t2 from the center, and squared in-plane
+// distance tp2 for count points, kept free of branches and of sqrt, which sets errno, so that the
+// compiler can vectorize it
+void Path::kernel_plane (long unsigned int count, const double *x, const double *y, const double *z, double *__restrict d, double *__restrict t2, double *__restrict tp2)
+{
+   double cx=kernel.center[0],cy=kernel.center[1],cz=kernel.center[2];
+   double ux=kernel.u[0],uy=kernel.u[1],uz=kernel.u[2];
+
+   long unsigned int i=0;
+   while (i < count) {
+      double dx=x[i]-cx,dy=y[i]-cy,dz=z[i]-cz;
+      double dd=dx*ux+dy*uy+dz*uz;
+      double tt=dx*dx+dy*dy+dz*dz;
+      d[i]=dd;
+      t2[i]=tt;
+      tp2[i]=max(tt-dd*dd,0.0);
+      i++;
+   }
+}
+
+// is_point_on_path for a point already in the path's frame, checking only the edges in its bin
+bool Path::kernel_on_path (struct point p)
+{
+   if (kernel.binStart.size() == 0) return false;
+
+   double q=p.x;
+   if (kernel.axisB == 1) q=p.y;
+   if (kernel.axisB == 2) q=p.z;
+
+   long unsigned int binCount=kernel.binStart.size()-1;
+   double position=(q-kernel.binLow)*kernel.binScale;
+   if (!(position >= 0 && position <= binCount)) return false;
+   long unsigned int bin=min(binCount-1,(long unsigned int)position);
+
+   long unsigned int n=xList.size();
+   long unsigned int k=kernel.binStart[bin];
+   while (k < kernel.binStart[bin+1]) {
+      long unsigned int i=kernel.binEdges[k];
+      if (is_point_on_line(p,point_at(i),point_at((i+1)%n),tol)) return true;
+      k++;
+   }
+
+   return false;
+}
+
+// Interior test for a point in the path's frame that is not on the path, given its kernel_plane
+// results.  Returns 1 for interior, 0 for not, and -1 when the point is too close to a tolerance
+// or to an edge for the result to match the angle sum, so that the caller falls back to it.
+int Path::kernel_interior (struct point p, double d, double t2, double tp2)
+{
+   double t=sqrt(t2);
+   double tp=sqrt(tp2);
+
+   const double *c[3]={xList.data(),yList.data(),zList.data()};
+   const double *a=c[kernel.axisA];
+   const double *b=c[kernel.axisB];
+   double pc[3]={p.x,p.y,p.z};
+   double qa=pc[kernel.axisA];
+   double qb=pc[kernel.axisB];
+
+   // outside the binned range, the point is off the plane or outside the path, so not interior either way
+   long unsigned int binCount=kernel.binStart.size()-1;
+   double position=(qb-kernel.binLow)*kernel.binScale;
+   if (!(position >= 0 && position <= binCount)) return 0;
+   long unsigned int bin=min(binCount-1,(long unsigned int)position);
+
+   // planarity, as the loop of tetrahedra_volume checks in interior_by_angles
+   double center=fabs(d)*kernel.maxS/6;
+   double spread=(kernel.maxW+tp*kernel.maxE)/6;
+   double slack=64*DBL_EPSILON*pow(t+kernel.radius,3);
+   if (center-spread-slack > kernel.planeTol) return 0;
+   if (center+spread+slack > kernel.planeTol) return -1;
+
+   // the angle sum only equals 2*pi times the winding number for points in the plane
+   if (fabs(d) > 1e-12*kernel.radius) return -1;
+
+   // winding number from the edges crossing the ray from p along axisA
+   long unsigned int n=xList.size();
+   int winding=0;
+   long unsigned int k=kernel.binStart[bin];
+   while (k < kernel.binStart[bin+1]) {
+      long unsigned int i=kernel.binEdges[k];
+      long unsigned int j=(i+1)%n;
+      bool upward=(b[i] <= qb && b[j] > qb);
+      bool downward=(b[j] <= qb && b[i] > qb);
+      if (upward || downward) {
+         double left=(a[j]-a[i])*(qb-b[i])-(qa-a[i])*(b[j]-b[i]);
+         if (fabs(left) <= 1e-12*(fabs(a[j]-a[i])*fabs(qb-b[i])+fabs(qa-a[i])*fabs(b[j]-b[i]))) return -1;
+         if (upward && left > 0) winding++;
+         if (downward && left < 0) winding--;
+      }
+      k++;
+   }
+
+   if (abs(winding) == 1) return 1;
+   return 0;
+}
+
+// the original interior test for a point in the path's frame
+bool Path::interior_by_angles (struct point p1)
+{
+   if (!kernel.valid) build_kernel();
 
    // all tetrahedral volumes must be zero to be in the same plane
    long unsigned int i=0;
-   while (i < points.size()-2) {
-      struct point p2=points[i]->get_point_value();
-      struct point p3=points[i+1]->get_point_value();
-      struct point p4=points[i+2]->get_point_value();
-      if (abs(tetrahedra_volume(p1,p2,p3,p4)) > tol) return false;
+   while (i < xList.size()-2) {
+      struct point p2=point_at(i);
+      struct point p3=point_at(i+1);
+      struct point p4=point_at(i+2);
+      if (abs(tetrahedra_volume(p1,p2,p3,p4)) > kernel.planeTol) return false;
 
       i++;
    }
@@ -1256,47 +1503,104 @@ bool Path::is_point_interior (struct point p1)
    return false;
 }
 
-bool Path::is_point_on_path (struct point p)
+// interior test for a point in the path's frame that is not on the path
+bool Path::interior_off_path (struct point p1, double d, double t2, double tp2)
 {
-   if (points.size() == 0) return false;
+   if (xList.size() < 2) return false;
 
-   if (rotated) rotatePoint(&p);
+   // tetrahedra_volume is -DBL_MAX unless all points are 3D, so nothing is interior to a 2D path
+   if (xList.size() > 2 && (p1.dim != 3 || pointDim != 3)) return false;
 
-   long unsigned int i=0;
-   while (i < points.size()-1) {
-      if (is_point_on_line(p,points[i]->get_point_value(),points[i+1]->get_point_value(),tol)) return true;
-      i++;
+   if (kernel.usable && p1.dim == 3) {
+      int result=kernel_interior(p1,d,t2,tp2);
+      if (result >= 0) return result == 1;
    }
 
-   if (is_closed()) {
-      if (is_point_on_line(p,points[i]->get_point_value(),points[0]->get_point_value(),tol)) return true;
-   }
+   return interior_by_angles(p1);
+}
 
-   return false;
+// define interior as NOT including the lines themselves
+bool Path::is_point_interior (struct point p1)
+{
+   if (xList.size() < 2) return false;
+
+   if (is_point_on_path(p1)) return false;
+
+   if (rotated) rotatePoint(&p1);
+
+   double d=0,t2=0,tp2=0;
+   if (kernel.usable && p1.dim == 3) kernel_plane(1,&p1.x,&p1.y,&p1.z,&d,&t2,&tp2);
+
+   return interior_off_path(p1,d,t2,tp2);
+}
+
+bool Path::is_point_on_path (struct point p)
+{
+   if (xList.size() == 0) return false;
+
+   if (rotated) rotatePoint(&p);
+
+   if (!kernel.valid) build_kernel();
+   return kernel_on_path(p);
 }
 
 // define inside as including the lines themselves
 bool Path::is_point_inside (struct point p)
 {
    if (is_point_on_path(p)) return true;
-   if (is_point_interior(p)) return true;
-   return false;
+   return is_point_interior(p);
+}
+
+// is_point_inside for count points given as coordinate arrays, with z set to nullptr for 2D points
+void Path::is_point_inside (long unsigned int count, const double *x, const double *y, const double *z, bool *inside)
+{
+   if (!kernel.valid) build_kernel();
+
+   int dim=3;
+   if (z == nullptr) dim=2;
+
+   // into the path's frame
+   vector<double> px(x,x+count),py(y,y+count),pz(count,0);
+   if (dim == 3) pz.assign(z,z+count);
+   if (rotated) {
+      double ct=cos_theta_,st=sin_theta_,cp=cos_phi_,sp=sin_phi_;
+      long unsigned int i=0;
+      while (i < count) {
+         double xr=ct*cp*px[i]-ct*sp*py[i]+st*pz[i];
+         double yr=sp*px[i]+cp*py[i];
+         double zr=-st*cp*px[i]+st*sp*py[i]+ct*pz[i];
+         px[i]=xr; py[i]=yr; pz[i]=zr;
+         i++;
+      }
+   }
+
+   vector<double> d(count,0),t2(count,0),tp2(count,0);
+   if (kernel.usable && dim == 3) kernel_plane(count,px.data(),py.data(),pz.data(),d.data(),t2.data(),tp2.data());
+
+   long unsigned int i=0;
+   while (i < count) {
+      struct point p; p.dim=dim; p.x=px[i]; p.y=py[i]; p.z=pz[i];
+      inside[i]=false;
+      if (xList.size() > 0 && kernel_on_path(p)) inside[i]=true;
+      else inside[i]=interior_off_path(p,d[i],t2[i],tp2[i]);
+      i++;
+   }
 }
 
 bool Path::does_line_intersect (struct point pt1, struct point pt2)
 {
    long unsigned int i;
-   if (points.size() == 0) return false;
+   if (xList.size() == 0) return false;
 
    // check each segment
    i=0;
-   while (i < points.size()-1) {
-      if (do_intersect (points[i]->get_point_value(),points[i+1]->get_point_value(),pt1,pt2,tol)) return true;
+   while (i < xList.size()-1) {
+      if (do_intersect (point_at(i),point_at(i+1),pt1,pt2,tol)) return true;
       i++;
    }
 
    if (is_closed()) {
-      if (do_intersect (points[i]->get_point_value(),points[0]->get_point_value(),pt1,pt2,tol)) return true;
+      if (do_intersect (point_at(i),point_at(0),pt1,pt2,tol)) return true;
    }
 
    return false;
@@ -1304,10 +1608,10 @@ bool Path::does_line_intersect (struct point pt1, struct point pt2)
 
 bool Path::is_path_overlap (Path *test)
 {
-   if (test->points.size() == 0) return false;
+   if (test->xList.size() == 0) return false;
 
    long unsigned int i=0;
-   while (i < test->points.size()-1) {
+   while (i < test->xList.size()-1) {
       if (does_line_intersect (test->get_point_value(i),test->get_point_value(i+1))) {
          return true;
       }
@@ -1327,7 +1631,7 @@ bool Path::is_path_inside (Path *test)
 {
    // check for points inside the path
    long unsigned int i=0;
-   while (i < test->points.size()) {
+   while (i < test->xList.size()) {
       if (! is_point_inside(test->get_point_value(i))) return false;
       i++;
    }
@@ -1359,7 +1663,7 @@ void Path::test_is_point_inside_m ()
    double xt,yt,zt;
    string expected="";
 
-   if (points.size() < 3) {
+   if (xList.size() < 3) {
       prefix(); PetscPrintf(PETSC_COMM_WORLD,"ASSERT: Path::test_is_point_inside was passed a point or a line.\n");
       return;
    }
@@ -1520,7 +1824,7 @@ void Path::test_is_point_inside_mr ()
    double xt,yt,zt;
    string expected="";
 
-   if (points.size() < 3) {
+   if (xList.size() < 3) {
       prefix(); PetscPrintf(PETSC_COMM_WORLD,"ASSERT: Path::test_is_point_inside was passed a point or a line.\n");
       return;
    }
@@ -1678,7 +1982,7 @@ void Path::test_is_point_inside_sqr2 ()
    double xt,yt,zt;
    string expected="";
 
-   if (points.size() < 3) {
+   if (xList.size() < 3) {
       prefix(); PetscPrintf(PETSC_COMM_WORLD,"ASSERT: Path::test_is_point_inside was passed a point or a line.\n");
       return;
    }
@@ -1754,52 +2058,358 @@ void Path::test_is_point_inside_sqr2 ()
    else cout << "(" << xt << "," << yt << "," << zt << ") is outside, expected=" << expected << endl;
 }
 
-bool Path::snapToMeshBoundary (Mesh *mesh)
+// Check the interior test with the kernel against the angle sum at count random points in the plane
+// of the path, spread over and around it in the path's frame, and time both.  The kernel must agree
+// at every point.  The number of points the kernel decides without falling back to the angle sum is
+// reported, since a kernel that always falls back agrees but gives no speedup.
+void Path::test_is_point_inside (long unsigned int count)
+{
+   if (xList.size() < 3) {
+      prefix(); PetscPrintf(PETSC_COMM_WORLD,"ASSERT: Path::test_is_point_inside was passed a point or a line.\n");
+      return;
+   }
+   if (!kernel.valid) build_kernel();
+
+   long unsigned int n=xList.size();
+   vector<double> x(count),y(count),z(count);
+   mt19937 generator(1);
+   uniform_real_distribution<double> spread(-0.5,1.5);
+   long unsigned int i=0;
+   while (i < count) {
+      struct point p1=point_at(generator()%n);
+      struct point p2=point_at(generator()%n);
+      struct point p3=point_at(generator()%n);
+      struct point p=point_addition(p1,point_addition(point_scale(spread(generator),point_subtraction(p2,p1)),
+                                                      point_scale(spread(generator),point_subtraction(p3,p1))));
+      x[i]=p.x; y[i]=p.y; z[i]=p.z;
+      i++;
+   }
+
+   vector<bool> onPath(count);
+   i=0;
+   while (i < count) {
+      struct point p; p.dim=pointDim; p.x=x[i]; p.y=y[i]; p.z=z[i];
+      onPath[i]=kernel_on_path(p);
+      i++;
+   }
+
+   vector<double> d(count,0),t2(count,0),tp2(count,0);
+   vector<bool> angles(count),kernelResult(count);
+
+   bool usable=kernel.usable;
+   kernel.usable=false;
+   chrono::steady_clock::time_point start=chrono::steady_clock::now();
+   i=0;
+   while (i < count) {
+      struct point p; p.dim=pointDim; p.x=x[i]; p.y=y[i]; p.z=z[i];
+      if (!onPath[i]) angles[i]=interior_off_path(p,d[i],t2[i],tp2[i]);
+      i++;
+   }
+   kernel.usable=usable;
+
+   chrono::steady_clock::time_point middle=chrono::steady_clock::now();
+   if (kernel.usable) kernel_plane(count,x.data(),y.data(),z.data(),d.data(),t2.data(),tp2.data());
+   i=0;
+   while (i < count) {
+      struct point p; p.dim=pointDim; p.x=x[i]; p.y=y[i]; p.z=z[i];
+      if (!onPath[i]) kernelResult[i]=interior_off_path(p,d[i],t2[i],tp2[i]);
+      i++;
+   }
+   chrono::steady_clock::time_point stop=chrono::steady_clock::now();
+
+   long unsigned int mismatches=0;
+   long unsigned int decided=0;
+   i=0;
+   while (i < count) {
+      if (!onPath[i]) {
+         if (angles[i] != kernelResult[i]) mismatches++;
+         struct point p; p.dim=pointDim; p.x=x[i]; p.y=y[i]; p.z=z[i];
+         if (kernel.usable && p.dim == 3 && kernel_interior(p,d[i],t2[i],tp2[i]) >= 0) decided++;
+      }
+      i++;
+   }
+
+   double anglesTime=chrono::duration<double>(middle-start).count();
+   double kernelTime=chrono::duration<double>(stop-middle).count();
+   prefix(); PetscPrintf(PETSC_COMM_WORLD,"path %s interior: %ld points, %ld decided by the kernel, %ld mismatches, angle sum %g s, kernel %g s\n",
+                                          get_name().c_str(),count,decided,mismatches,anglesTime,kernelTime);
+   if (mismatches == 0) {prefix(); PetscPrintf(PETSC_COMM_WORLD,"path %s interior pass\n",get_name().c_str());}
+   else {prefix(); PetscPrintf(PETSC_COMM_WORLD,"path %s interior FAIL\n",get_name().c_str());}
+}
+
+long unsigned int boundaryVertexIndex::bucket (long long i, long long j, long long k)
+{
+   unsigned long long h=(unsigned long long)i*73856093ULL^(unsigned long long)j*19349663ULL^(unsigned long long)k*83492791ULL;
+   h^=h>>29;
+   h*=0xbf58476d1ce4e5b9ULL;
+   h^=h>>32;
+   return h&mask;
+}
+
+void boundaryVertexIndex::build (Mesh *mesh)
+{
+   dim=mesh->Dimension();
+   maxAbs=0;
+   xList.clear();
+   yList.clear();
+   zList.clear();
+
+   // the vertices of the triangles in boundary element order, keeping only the first appearance
+   // of each vertex so that the lowest index is the match found first by a search of the elements
+   if (dim == 3) {
+      vector<bool> seen(mesh->GetNV(),false);
+      Array<int> vertices;
+      int j=0;
+      while (j < mesh->GetNBE()) {
+         if (mesh->GetBdrElementType(j) == Element::TRIANGLE) {
+            mesh->GetBdrElementVertices(j,vertices);
+            int k=0;
+            while (k < vertices.Size()) {
+               int v=vertices[k];
+               if (!seen[v]) {
+                  seen[v]=true;
+                  const double *c=mesh->GetVertex(v);
+                  if (isfinite(c[0]) && isfinite(c[1]) && isfinite(c[2])) {
+                     xList.push_back(c[0]);
+                     yList.push_back(c[1]);
+                     zList.push_back(c[2]);
+                     maxAbs=max(maxAbs,max(fabs(c[0]),max(fabs(c[1]),fabs(c[2]))));
+                  }
+               }
+               k++;
+            }
+         }
+         j++;
+      }
+   }
+
+   // point_comparison matches coordinates within max(SNAP_TOL*|a|,2*SNAP_TOL), and a matching
+   // coordinate is no larger than about maxAbs, so matches are at most one cell apart
+   cellSize=max(SNAP_TOL*maxAbs,2*SNAP_TOL)*(1+1e-6);
+
+   long unsigned int bucketCount=1;
+   while (bucketCount < xList.size()) bucketCount*=2;
+   mask=bucketCount-1;
+
+   // counting sort into the buckets, keeping the vertices in increasing order within each
+   vector<long unsigned int> bucketList(xList.size());
+   bucketStart.assign(bucketCount+1,0);
+   long unsigned int i=0;
+   while (i < xList.size()) {
+      bucketList[i]=bucket(cell(xList[i]),cell(yList[i]),cell(zList[i]));
+      bucketStart[bucketList[i]+1]++;
+      i++;
+   }
+
+   i=0;
+   while (i < bucketCount) {bucketStart[i+1]+=bucketStart[i]; i++;}
+
+   vector<long unsigned int> fill(bucketStart.begin(),bucketStart.end()-1);
+   bucketVertices.resize(xList.size());
+   i=0;
+   while (i < xList.size()) {
+      bucketVertices[fill[bucketList[i]]]=i;
+      fill[bucketList[i]]++;
+      i++;
+   }
+}
+
+// find the boundary vertex that snapToMeshBoundary matches to p, returning false if there is none
+bool boundaryVertexIndex::find (struct point p, struct point *vertex)
+{
+   if (p.dim != 3 || xList.size() == 0) return false;
+
+   // nothing can match further out, and this keeps the cells in range
+   double limit=2*maxAbs+1;
+   if (!(fabs(p.x) <= limit && fabs(p.y) <= limit && fabs(p.z) <= limit)) return false;
+
+   long long cx=cell(p.x);
+   long long cy=cell(p.y);
+   long long cz=cell(p.z);
+
+   long unsigned int best=xList.size();
+   long long i=-1;
+   while (i <= 1) {
+      long long j=-1;
+      while (j <= 1) {
+         long long k=-1;
+         while (k <= 1) {
+            long unsigned int b=bucket(cx+i,cy+j,cz+k);
+            long unsigned int m=bucketStart[b];
+            while (m < bucketStart[b+1] && bucketVertices[m] < best) {
+               long unsigned int v=bucketVertices[m];
+               struct point q; q.dim=3; q.x=xList[v]; q.y=yList[v]; q.z=zList[v];
+               if (point_comparison(p,q,SNAP_TOL)) {best=v; break;}
+               m++;
+            }
+            k++;
+         }
+         j++;
+      }
+      i++;
+   }
+
+   if (best == xList.size()) return false;
+
+   vertex->dim=3;
+   vertex->x=xList[best];
+   vertex->y=yList[best];
+   vertex->z=zList[best];
+   return true;
+}
+
+bool Path::snapToMeshBoundary (boundaryVertexIndex *index)
 {
    bool fail=false;
-   DenseMatrix pointMat(3,3);
 
    // nothing to do
-   if (points.size() == 0) return false;
+   if (xList.size() == 0) return false;
 
    // check for dimensional alignment
-   if (mesh->Dimension() != points[0]->get_point_value_dim()) {
+   if (index->get_dim() != pointDim) {
       prefix(); PetscPrintf(PETSC_COMM_WORLD,"ASSERT: Path::snapToMesh passed mismatched dimensions.\n");
       return true;
    }
 
    long unsigned int i=0;
-   while (i < points.size()) {
-      bool found_point=false;
-      int j=0;
-      while (j < mesh->GetNBE()) {
-         if (mesh->GetBdrElementType(j) == Element::TRIANGLE) {
-            mesh->GetBdrPointMatrix(j,pointMat);
-            struct point p1; p1.dim=3; p1.x=pointMat.Elem(0,0); p1.y=pointMat.Elem(1,0); p1.z=pointMat.Elem(2,0);
-            struct point p2; p2.dim=3; p2.x=pointMat.Elem(0,1); p2.y=pointMat.Elem(1,1); p2.z=pointMat.Elem(2,1);
-            struct point p3; p3.dim=3; p3.x=pointMat.Elem(0,2); p3.y=pointMat.Elem(1,2); p3.z=pointMat.Elem(2,2);
-
-            if (points[i]->is_close_point(p1)) {
-               points[i]->set_point_value(p1);
-               found_point=true;
-               break;
-            } else if (points[i]->is_close_point(p2)) {
-               points[i]->set_point_value(p2);
-               found_point=true;
-               break;
-            } else if (points[i]->is_close_point(p3)) {
-               points[i]->set_point_value(p3);
-               found_point=true;
-               break;
-            } 
+   while (i < xList.size()) {
+      struct point vertex;
+      if (index->find(point_at(i),&vertex)) set_point(i,vertex);
+      else fail=true;
+      i++;
+   }
+
+   return fail;
+}
+
+bool Path::snapToMeshBoundary (Mesh *mesh)
+{
+   // nothing to do
+   if (xList.size() == 0) return false;
+
+   // check for dimensional alignment
+   if (mesh->Dimension() != pointDim) {
+      prefix(); PetscPrintf(PETSC_COMM_WORLD,"ASSERT: Path::snapToMesh passed mismatched dimensions.\n");
+      return true;
+   }
+
+   boundaryVertexIndex index;
+   index.build(mesh);
+   return snapToMeshBoundary(&index);
+}
+
+// snap all of the paths with one index of the mesh boundary
+bool snapToMeshBoundary (vector<Path *> *pathList, Mesh *mesh)
+{
+   bool fail=false;
+
+   if (pathList->size() == 0) return false;
+
+   boundaryVertexIndex index;
+   index.build(mesh);
+
+   long unsigned int i=0;
+   while (i < pathList->size()) {
+      if ((*pathList)[i]->snapToMeshBoundary(&index)) fail=true;
+      i++;
+   }
+
+   return fail;
+}
+
+// the search of every boundary element that boundaryVertexIndex replaces, the reference for test_snapToMeshBoundary
+bool snap_by_search (Mesh *mesh, struct point p, struct point *vertex)
+{
+   DenseMatrix pointMat(3,3);
+
+   int j=0;
+   while (j < mesh->GetNBE()) {
+      if (mesh->GetBdrElementType(j) == Element::TRIANGLE) {
+         mesh->GetBdrPointMatrix(j,pointMat);
+         int k=0;
+         while (k < 3) {
+            struct point q; q.dim=3; q.x=pointMat.Elem(0,k); q.y=pointMat.Elem(1,k); q.z=pointMat.Elem(2,k);
+            if (point_comparison(p,q,SNAP_TOL)) {
+               *vertex=q;
+               return true;
+            }
+            k++;
          }
-         j++;
       }
-      if (!found_point) fail=true;
+      j++;
+   }
+
+   return false;
+}
+
+// Snap count points near the boundary vertices of a 3D mesh by searching every boundary element and
+// with boundaryVertexIndex, and time both.  The index must find the same vertex as the search for
+// every point.  The points are vertices moved inside and outside of the tolerance and points
+// scattered over the bounding box.
+void test_snapToMeshBoundary (Mesh *mesh, long unsigned int count)
+{
+   long unsigned int mismatches=0;
+
+   if (mesh->Dimension() != 3 || mesh->GetNV() == 0) {
+      prefix(); PetscPrintf(PETSC_COMM_WORLD,"ASSERT: test_snapToMeshBoundary was passed a mesh that is not 3D or has no vertices.\n");
+      return;
+   }
+
+   Vector lower,upper;
+   mesh->GetBoundingBox(lower,upper,1);
+
+   mt19937 generator(count);
+   uniform_real_distribution<double> unit(0,1);
+   uniform_int_distribution<int> vertexPick(0,mesh->GetNV()-1);
+
+   vector<struct point> pointList(count);
+   long unsigned int i=0;
+   while (i < count) {
+      struct point p; p.dim=3;
+      if (i%3 == 2) {
+         p.x=lower.Elem(0)+unit(generator)*(upper.Elem(0)-lower.Elem(0));
+         p.y=lower.Elem(1)+unit(generator)*(upper.Elem(1)-lower.Elem(1));
+         p.z=lower.Elem(2)+unit(generator)*(upper.Elem(2)-lower.Elem(2));
+      } else {
+         double scale=SNAP_TOL*(i%3 == 0 ? 0.5 : 2)*(2*unit(generator)-1);
+         const double *c=mesh->GetVertex(vertexPick(generator));
+         p.x=c[0]+scale*max(fabs(c[0]),1.0);
+         p.y=c[1]+scale*max(fabs(c[1]),1.0);
+         p.z=c[2]+scale*max(fabs(c[2]),1.0);
+      }
+      pointList[i]=p;
       i++;
    }
 
-   return fail;
+   vector<bool> searchFound(count);
+   vector<struct point> searchVertex(count);
+   chrono::steady_clock::time_point start=chrono::steady_clock::now();
+   i=0;
+   while (i < count) {
+      searchFound[i]=snap_by_search(mesh,pointList[i],&searchVertex[i]);
+      i++;
+   }
+   chrono::steady_clock::time_point middle=chrono::steady_clock::now();
+   boundaryVertexIndex index;
+   index.build(mesh);
+   long unsigned int found=0;
+   i=0;
+   while (i < count) {
+      struct point vertex;
+      bool indexFound=index.find(pointList[i],&vertex);
+      if (indexFound) found++;
+      if (indexFound != searchFound[i]) mismatches++;
+      else if (indexFound && (vertex.x != searchVertex[i].x || vertex.y != searchVertex[i].y || vertex.z != searchVertex[i].z)) mismatches++;
+      i++;
+   }
+   chrono::steady_clock::time_point stop=chrono::steady_clock::now();
+
+   double searchTime=chrono::duration<double>(middle-start).count();
+   double indexTime=chrono::duration<double>(stop-middle).count();
+   prefix(); PetscPrintf(PETSC_COMM_WORLD,"snap to mesh boundary: %ld points, %ld found, %ld mismatches, search %g s, index %g s, speedup %g\n",
+                                          count,found,mismatches,searchTime,indexTime,indexTime > 0 ? searchTime/indexTime : 0);
+   if (mismatches == 0) {prefix(); PetscPrintf(PETSC_COMM_WORLD,"snap to mesh boundary pass\n");}
+   else {prefix(); PetscPrintf(PETSC_COMM_WORLD,"snap to mesh boundary FAIL\n");}
 }
 
 double Path::area ()
@@ -1808,10 +2418,9 @@ double Path::area ()
    bool allocatedPath=false;
    double area=0;
 
-   if (points.size() == 0) return DBL_MAX;
+   if (xList.size() == 0) return DBL_MAX;
 
-   int dim=points[0]->get_point_value().dim;
-   if (dim == 2) path=this;
+   if (pointDim == 2) path=this;
    else {
       if (rotated) path=this;
       else {
@@ -1820,21 +2429,19 @@ double Path::area ()
       }
    }
 
-   // 2D from now on
+   // 2D from now on, so the shoelace sum over the coordinate arrays
+
+   const double *x=path->xList.data();
+   const double *y=path->yList.data();
+   long unsigned int n=path->xList.size();
 
    long unsigned int j=0;
-   while (j < path->points.size()-1) {
-      struct point p1=path->points[j]->get_point_value();
-      struct point p2=path->points[j+1]->get_point_value();
-      area+=point_cross_product(p1,p2).z;
+   while (j < n-1) {
+      area+=x[j]*y[j+1]-x[j+1]*y[j];
       j++;
    }
 
-   if (get_closed()) {
-      struct point p1=path->points[points.size()-1]->get_point_value();
-      struct point p2=path->points[0]->get_point_value();
-      area+=point_cross_product(p1,p2).z;
-   }
+   if (get_closed()) area+=x[n-1]*y[0]-x[0]*y[n-1];
 
    if (allocatedPath) delete path;
 
@@ -1845,19 +2452,11 @@ double Path::area ()
 
 void Path::reverseOrder ()
 {
-   vector<keywordPair *> reversed_points;
-
-   long unsigned int i=0;
-   while (i < points.size()) {
-      reversed_points.push_back(points[points.size()-1-i]);
-      i++;
-   }
-
-   i=0;
-   while (i < points.size()) {
-      points[i]=reversed_points[i];
-      i++;
-   }
+   kernel.valid=false;
+   reverse(xList.begin(),xList.end());
+   reverse(yList.begin(),yList.end());
+   reverse(zList.begin(),zList.end());
+   reverse(lineNumberList.begin(),lineNumberList.end());
 
    // post-operations to align with Path::load
    calculateBoundingBox();
@@ -1868,16 +2467,16 @@ void Path::reverseOrder ()
 bool Path::lineIntersects (struct point a, struct point b)
 {
    // do not check for paths that are lines
-   if (points.size() <= 2) return false;
+   if (xList.size() <= 2) return false;
 
    double volume_a=0;
    double volume_b=0;
 
-   struct point p1=points[0]->get_point_value();
+   struct point p1=point_at(0);
    long unsigned int i=1;
-   while (i < points.size()-1) {
-      struct point p2=points[i]->get_point_value();
-      struct point p3=points[i+1]->get_point_value();
+   while (i < xList.size()-1) {
+      struct point p2=point_at(i);
+      struct point p3=point_at(i+1);
 
       volume_a+=tetrahedra_volume(a,p1,p2,p3);
       volume_b+=tetrahedra_volume(b,p1,p2,p3);
@@ -1890,9 +2489,9 @@ bool Path::lineIntersects (struct point a, struct point b)
 
    bool sign=false;
    i=0;
-   while (i < points.size()-1) {
-      struct point p1=points[i]->get_point_value();
-      struct point p2=points[i+1]->get_point_value();
+   while (i < xList.size()-1) {
+      struct point p1=point_at(i);
+      struct point p2=point_at(i+1);
       double volume=tetrahedra_volume(a,p1,p2,b);
 
       // co-linear, so must intersect
@@ -1928,16 +2527,16 @@ struct point Path::getInsidePoint ()
    double area_tolerance=path_area*1e-6;
 
    // do not check for paths that are lines
-   if (points.size() <= 2) {
+   if (xList.size() <= 2) {
       prefix(); PetscPrintf(PETSC_COMM_WORLD,"ASSERT: Path::getInsidePoint passed invalid path.\n");
       return error_point;
    }
 
    long unsigned int i=0;
-   while (i < points.size()-2) {
-      struct point p1=points[i]->get_point_value();
-      struct point p2=points[i+1]->get_point_value();
-      struct point p3=points[i+2]->get_point_value();
+   while (i < xList.size()-2) {
+      struct point p1=point_at(i);
+      struct point p2=point_at(i+1);
+      struct point p3=point_at(i+2);
 
       double area=triangle_area(p1,p2,p3);
 
@@ -1952,12 +2551,3 @@ struct point Path::getInsidePoint ()
    // should not get to here
    return error_point;
 }
-
-Path::~Path ()
-{
-   long unsigned int i=0;
-   while (i < points.size()) {
-      delete points[i];
-      i++;
-   }
-}
@@ -27,6 +27,9 @@
 #include <sstream>
 #include <string>
 #include <limits>
+#include <deque>
+#include <random>
+#include <chrono>
 #include "petscsys.h"
 #include "keywordPair.hpp"
 #include "misc.hpp"
@@ -47,12 +50,71 @@ struct point point_normalize (struct point);
 bool point_comparison (struct point, struct point, double);
 void point_print (struct point);
 
+// keyword indexes in the Path schema
+#define PATH_NAME 0
+#define PATH_CLOSED 1
+#define PATH_POINT 2
+
+// Point-in-polygon data for a path, built on first use and dropped when the points change.
+// Edges are binned along coordinate axisB so that a query only visits the edges spanning its
+// coordinate.  For a closed planar 3D path, the plane is projected onto axisA and axisB for a
+// winding number test, with bounds on the planarity volumes of is_point_interior kept so that
+// the plane check is O(1) per point.  The planarity volumes are compared against planeTol,
+// which scales with the cube of the path size so that the test, and the rounding slack of the
+// bounds, do not depend on the units of the coordinates.
+struct pathKernel {
+   bool valid=false;
+   bool usable=false;          // closed 3D path with a plane and a normal, else the angle sum is used
+   int axisA=0;                // crossing ray direction
+   int axisB=1;                // binned coordinate
+   double center[3];
+   double u[3];                // unit normal of the plane
+   double radius=0;            // furthest point from center
+   double planeTol;            // tetrahedra volume tolerance of the planarity test, tol*max(1,radius)^3
+   double maxW,maxS,maxE,maxN; // planarity volume bounds, see Path::build_kernel
+   double binLow;
+   double binScale;
+   vector<long unsigned int> binStart;
+   vector<long unsigned int> binEdges;
+};
+
+// matching tolerance of Path::snapToMeshBoundary
+#define SNAP_TOL 1e-8
+
+// Vertices of the triangle boundary elements of a 3D mesh, hashed into cells no smaller than the
+// SNAP_TOL match distance so that a point only visits the vertices in its 27 neighboring cells.
+// Built once per mesh and shared by all of the paths snapped to it.
+class boundaryVertexIndex {
+   private:
+      int dim=0;
+      double maxAbs=0;
+      double cellSize=1;
+      vector<double> xList;                    // vertices in boundary element order
+      vector<double> yList;
+      vector<double> zList;
+      long unsigned int mask=0;
+      vector<long unsigned int> bucketStart;   // vertices of bucket b are bucketVertices[bucketStart[b]...bucketStart[b+1]-1]
+      vector<long unsigned int> bucketVertices;
+      long long cell (double a) {return (long long)floor(a/cellSize);}
+      long unsigned int bucket (long long, long long, long long);
+   public:
+      void build (Mesh *);
+      bool find (struct point, struct point *);
+      int get_dim () {return dim;}
+      long unsigned int get_size () {return xList.size();}
+};
+
 class Path {
    private:
       int startLine;
       int endLine;
       keywordPair name;
-      vector<keywordPair *> points;
+      int pointDim=0;
+      vector<double> xList;           // points as contiguous coordinate arrays
+      vector<double> yList;
+      vector<double> zList;
+      vector<int> lineNumberList;     // input line of each point, for diagnostics
+      deque<keywordPair> pointPairList;  // for the keywordPair accessors only, see get_point; never shrinks
       keywordPair closed;
       double tol=1e-11; // 1e-11
       bool hasNormal;
@@ -68,9 +130,18 @@ class Path {
       double ymax,ymin;
       double zmax,zmin;
       bool hasOutput;
+      pathKernel kernel;
+      void build_kernel ();
+      void kernel_plane (long unsigned int, const double *, const double *, const double *, double *__restrict, double *__restrict, double *__restrict);
+      int kernel_interior (struct point, double, double, double);
+      bool kernel_on_path (struct point);
+      bool interior_by_angles (struct point);
+      bool interior_off_path (struct point, double, double, double);
+      struct point point_at (long unsigned int i) {struct point p; p.dim=pointDim; p.x=xList[i]; p.y=yList[i]; p.z=zList[i]; return p;}
+      void set_point (long unsigned int i, struct point p) {kernel.valid=false; pointDim=p.dim; xList[i]=p.x; yList[i]=p.y; zList[i]=p.z;}
+      const keywordPair* point_pair (long unsigned int);
    public:
       Path (int, int);
-      ~Path ();
       bool load (int, string *, inputFile *);
       bool inBlock (int);
       bool check (string *);
@@ -82,21 +153,32 @@ class Path {
       int get_closed_lineNumber () {return closed.get_lineNumber();}
       int get_startLine () {return startLine;}
       int get_endLine () {return endLine;}
-      long unsigned int get_points_size () {return points.size();}
-      keywordPair* get_point (long unsigned int i) {return points[i];}
+      long unsigned int get_points_size () {return xList.size();}
       void offset (struct point);
       struct point get_point_value (long unsigned int);
-      int get_point_dim (long unsigned int i) {return points[i]->get_point_value_dim();}
-      void push_point (keywordPair *point) {points.push_back(point);}
-      void pop_point () {points.pop_back();}
+      void set_point_value (long unsigned int i, struct point p) {set_point(i,p);}
+      int get_point_dim (long unsigned int i) {return pointDim;}
+      int get_point_lineNumber (long unsigned int i) {return lineNumberList[i];}
+      void push_point (struct point, int);
+      void pop_point ();
+
+      // Read-only keywordPair accessors from before the points moved to coordinate arrays, kept for
+      // OpenParEM2D and OpenParEM3D.  The keywordPair is a snapshot of the point and its line number
+      // taken by the call, so it does not follow later changes from offset, rotation, or snapping.
+      // The pointer stays valid for the life of the path.  Change points with set_point_value and read
+      // them with get_point_value, get_point_lineNumber, get_startPoint_value, and get_endPoint_value.
+      const keywordPair* get_point (long unsigned int i) {return point_pair(i);}
+      const keywordPair* get_startPoint () {return point_pair(0);}
+      const keywordPair* get_endPoint () {if (closed.get_bool_value()) return point_pair(0); return point_pair(xList.size()-1);}
+      void push_point (keywordPair *);
       bool compare (long unsigned int i, keywordPair test_point);
-      void set_closed (bool value) {closed.set_bool_value(value); closed.set_loaded(true);}
+      void set_closed (bool value) {kernel.valid=false; closed.set_bool_value(value); closed.set_loaded(true);}
       bool is_closed () {return closed.get_bool_value();}
       void set_name (string name_) {name.set_value(name_); name.set_loaded(true);}
       void set_hasOutput () {hasOutput=true;}
       void unset_hasOutput () {hasOutput=false;}
-      keywordPair* get_startPoint () {return points[0];}
-      keywordPair* get_endPoint () {if (closed.get_bool_value()) return points[0]; return points[points.size()-1];}
+      struct point get_startPoint_value () {return point_at(0);}
+      struct point get_endPoint_value () {if (closed.get_bool_value()) return point_at(0); return point_at(xList.size()-1);}
       long unsigned int is_segmentOnLine (struct point, struct point);
       bool does_line_intersect (struct point, struct point);
       bool is_path_overlap (Path *);
@@ -104,7 +186,7 @@ class Path {
       double sum_of_angles (struct point);
       bool calculateNormal ();
       struct point get_normal () {return normal;}
-      void set_normal (struct point normal_) {normal=point_copy(normal_);}
+      void set_normal (struct point normal_) {kernel.valid=false; normal=point_copy(normal_);}
       bool is_rotated () {return rotated;}
       Path* rotateToXYplane ();
       void rotatePoint (double *, double *, double *, bool);
@@ -114,16 +196,19 @@ class Path {
       void rotateToPath (Path *, bool);
       bool is_point_on_path (struct point);
       bool is_point_inside (struct point);
+      void is_point_inside (long unsigned int, const double *, const double *, const double *, bool *);
       bool is_point_interior (struct point);
       bool is_path_inside (Path *);
       void test_is_point_inside_m ();
       void test_is_point_inside_mr ();
       void test_is_point_inside_sqr2 ();
+      void test_is_point_inside (long unsigned int);
       Path* clone ();
       void calculateBoundingBox ();
       void print (string);
       bool output (ofstream *, int);
       bool snapToMeshBoundary (Mesh *);
+      bool snapToMeshBoundary (boundaryVertexIndex *);
       double area ();
       void reverseOrder ();
       bool lineIntersects (struct point, struct point);
@@ -131,6 +216,8 @@ class Path {
 };
 
 bool mergePaths (vector<Path *> *, vector<long unsigned int> *, vector<bool> *, string, string, Path **, double);
+bool snapToMeshBoundary (vector<Path *> *, Mesh *);
+void test_snapToMeshBoundary (Mesh *, long unsigned int);
 
 #endif
 
@@ -24,19 +24,16 @@
 // SourceFile
 ///////////////////////////////////////////////////////////////////////////////////////////
 
+static constexpr keywordSchema sourceFileSchema[]={
+   {{"name"},0,0,false,false}
+};
+
 SourceFile::SourceFile(int startLine_, int endLine_)
 {
    startLine=startLine_;
    endLine=endLine_;
 
-   // name
-   name.push_alias("name");
-   name.set_loaded(false);
-   name.set_positive_required(false);
-   name.set_non_negative_required(false);
-   name.set_lowerLimit(0);
-   name.set_upperLimit(0);
-   name.set_checkLimits(false);
+   name.set_schema(&sourceFileSchema[0],false);
 }
 
 bool SourceFile::load(string *indent, inputFile *inputs)
@@ -47,13 +44,12 @@ bool SourceFile::load(string *indent, inputFile *inputs)
    int stopLineNumber=inputs->get_previous_lineNumber(endLine);
    while (lineNumber <= stopLineNumber) {
 
-      string token,value,line;
-      line=inputs->get_line(lineNumber);
-      get_token_pair(&line,&token,&value,&lineNumber,*indent);
+      string_view token,value;
+      split_token_pair(inputs->get_line_view(lineNumber),&token,&value,lineNumber,indent->c_str());
 
       int recognized=0;
 
-      if (name.match_alias(&token)) {
+      if (name.match_alias(token)) {
          if (name.is_loaded()) {
             prefix(); PetscPrintf(PETSC_COMM_WORLD,"%s%sERROR1106: Duplicate entry at line %d for previous entry at line %d.\n",
                                                    indent->c_str(),indent->c_str(),lineNumber,name.get_lineNumber());
@@ -0,0 +1,257 @@
+////////////////////////////////////////////////////////////////////////////////
+//                                                                            //
+//    OpenParEM2D - A fullwave 2D electromagnetic simulator.                  //
+//    Copyright (C) 2025 Brian Young                                          //
+//                                                                            //
+//    This program is free software: you can redistribute it and/or modify    //
+//    it under the terms of the GNU General Public License as published by    //
+//    the Free Software Foundation, either version 3 of the License, or       //
+//    (at your option) any later version.                                     //
+//                                                                            //
+//    This program is distributed in the hope that it will be useful,         //
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of          //
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the           //
+//    GNU General Public License for more details.                            //
+//                                                                            //
+//    You should have received a copy of the GNU General Public License       //
+//    along with this program.  If not, see <http://www.gnu.org/licenses/>.   //
+//                                                                            //
+////////////////////////////////////////////////////////////////////////////////
+
+#include "sweepJournal.hpp"
+
+// for the signal handler and exit_job_on_error
+static int activeJournalFd=-1;
+static volatile sig_atomic_t preempted=0;
+
+// SIGUSR1 is the scheduler's warning and only syncs, while SIGTERM syncs and then terminates as before
+static void journal_signal_handler (int signum)
+{
+   preempted=1;
+   if (activeJournalFd >= 0) fsync(activeJournalFd);
+   if (signum == SIGTERM) {
+      signal(SIGTERM,SIG_DFL);
+      raise(SIGTERM);
+   }
+}
+
+void journal_flush ()
+{
+   if (activeJournalFd >= 0) fsync(activeJournalFd);
+}
+
+// true once SIGTERM or SIGUSR1 has been received
+bool journal_preempted ()
+{
+   if (preempted) return true;
+   return false;
+}
+
+// load the records of a previous run onto all ranks
+// a torn final line from an interrupted write is dropped
+bool SweepJournal::read ()
+{
+   PetscMPIInt rank;
+   MPI_Comm_rank(PETSC_COMM_WORLD, &rank);
+
+   string text;
+   long int length=0;
+   if (rank == 0) {
+      ifstream journal;
+      journal.open(filename.c_str(),ifstream::in);
+      if (journal.is_open()) {
+         stringstream ss;
+         ss << journal.rdbuf();
+         text=ss.str();
+         journal.close();
+      }
+      length=text.length();
+   }
+   MPI_Bcast(&length,1,MPI_LONG,0,PETSC_COMM_WORLD);
+   text.resize(length);
+   if (length > 0) MPI_Bcast(text.data(),(int)length,MPI_CHAR,0,PETSC_COMM_WORLD);
+
+   frequencyList.clear();
+   refinedList.clear();
+   meshSizeList.clear();
+   meshHashList.clear();
+   meshLocationList.clear();
+   resultLocationList.clear();
+
+   int lineNumber=0;
+   size_t position=0;
+   while (position < text.length()) {
+      size_t end=text.find('\n',position);
+      if (end == string::npos) break;
+      string line=text.substr(position,end-position);
+      position=end+1;
+      lineNumber++;
+
+      if (lineNumber == 1) {
+         if (line.compare(version_name+" "+version_value) != 0) {
+            prefix(); PetscPrintf(PETSC_COMM_WORLD,"ERROR1133: Journal \"%s\" is not version %s.\n",filename.c_str(),version_value.c_str());
+            return true;
+         }
+         continue;
+      }
+
+      vector<string> fields;
+      size_t start=0;
+      size_t tab=line.find('\t');
+      while (tab != string::npos) {
+         fields.push_back(line.substr(start,tab-start));
+         start=tab+1;
+         tab=line.find('\t',start);
+      }
+      fields.push_back(line.substr(start));
+
+      char *hashEnd=nullptr;
+      unsigned long long meshHash=0;
+      if (fields.size() == 7) meshHash=strtoull(fields[4].c_str(),&hashEnd,16);
+
+      double frequency;
+      int meshSize;
+      size_t errorPosition;
+
+      if (fields.size() != 7 || fields[0].compare("point") != 0 ||
+          parse_double(fields[1],&frequency,&errorPosition) != PARSE_OK || parse_int(fields[3],&meshSize,&errorPosition) != PARSE_OK ||
+          (fields[2].compare("0") != 0 && fields[2].compare("1") != 0) || fields[4].length() == 0 || *hashEnd != '\0') {
+         prefix(); PetscPrintf(PETSC_COMM_WORLD,"ERROR1134: Journal \"%s\" has an invalid record at line %d.\n",filename.c_str(),lineNumber);
+         return true;
+      }
+
+      frequencyList.push_back(frequency);
+      refinedList.push_back(fields[2].compare("1") == 0);
+      meshSizeList.push_back(meshSize);
+      meshHashList.push_back(meshHash);
+      meshLocationList.push_back(fields[5]);
+      resultLocationList.push_back(fields[6]);
+   }
+
+   return false;
+}
+
+// collective on PETSC_COMM_WORLD
+// With restart, the records of a previous run are loaded for restore and new records are appended.
+// Otherwise the journal starts over.
+bool SweepJournal::open (const char *baseName, bool restart)
+{
+   PetscMPIInt rank;
+   MPI_Comm_rank(PETSC_COMM_WORLD, &rank);
+
+   stringstream ss;
+   ss << "." << baseName << ".journal";
+   filename=ss.str();
+
+   if (restart && read()) return true;
+
+   int fail=0;
+   if (rank == 0) {
+      bool exists=false;
+      if (restart && std::filesystem::exists(filename)) exists=true;
+
+      int flags=O_WRONLY|O_CREAT|O_APPEND;
+      if (!exists) flags|=O_TRUNC;
+      fd=::open(filename.c_str(),flags,0644);
+
+      if (fd < 0) {
+         prefix(); PetscPrintf(PETSC_COMM_WORLD,"ERROR1135: Cannot open \"%s\" for writing.\n",filename.c_str());
+         fail=1;
+      } else if (!exists) {
+         string header=version_name+" "+version_value+"\n";
+         if (write(fd,header.c_str(),header.length()) != (ssize_t)header.length() || fsync(fd) != 0) {
+            prefix(); PetscPrintf(PETSC_COMM_WORLD,"ERROR1136: Failed to write to \"%s\".\n",filename.c_str());
+            fail=1;
+         }
+      }
+   }
+   MPI_Bcast(&fail,1,MPI_INT,0,PETSC_COMM_WORLD);
+   if (fail) return true;
+
+   if (rank == 0) {
+      activeJournalFd=fd;
+      struct sigaction action;
+      action.sa_handler=journal_signal_handler;
+      sigemptyset(&action.sa_mask);
+      action.sa_flags=0;
+      sigaction(SIGTERM,&action,nullptr);
+      sigaction(SIGUSR1,&action,nullptr);
+   }
+
+   return false;
+}
+
+// mark the recorded points as completed so that get_frequency skips them
+bool SweepJournal::restore (FrequencyPlan *plan)
+{
+   if (frequencyList.size() == 0) return false;
+
+   int unmatched=plan->restore(&frequencyList,&refinedList,&meshSizeList,&meshHashList);
+   prefix(); PetscPrintf(PETSC_COMM_WORLD,"Restored %ld completed frequencies from \"%s\".\n",frequencyList.size()-unmatched,filename.c_str());
+   if (unmatched > 0) {
+      prefix(); PetscPrintf(PETSC_COMM_WORLD,"ERROR1137: %d frequencies in \"%s\" are not in the frequency plan.\n",unmatched,filename.c_str());
+      return true;
+   }
+   return false;
+}
+
+// collective on PETSC_COMM_WORLD
+// call once the solution at the point is saved
+bool SweepJournal::record (FrequencyPlanPoint *planPoint, bool refined, string meshLocation, string resultLocation)
+{
+   PetscMPIInt rank;
+   MPI_Comm_rank(PETSC_COMM_WORLD, &rank);
+
+   int fail=0;
+   if (rank == 0 && fd >= 0) {
+      char frequency[32];
+      snprintf(frequency,32,"%.17g",planPoint->get_frequency());
+
+      stringstream ss;
+      ss << "point\t" << frequency << "\t" << refined << "\t" << planPoint->get_meshSize() << "\t"
+         << hex << planPoint->get_meshHash() << dec << "\t" << meshLocation << "\t" << resultLocation << "\n";
+      string line=ss.str();
+
+      if (write(fd,line.c_str(),line.length()) != (ssize_t)line.length() || fsync(fd) != 0) {
+         prefix(); PetscPrintf(PETSC_COMM_WORLD,"ERROR1138: Failed to write to \"%s\".\n",filename.c_str());
+         fail=1;
+      }
+   }
+   MPI_Bcast(&fail,1,MPI_INT,0,PETSC_COMM_WORLD);
+   if (fail) return true;
+   return false;
+}
+
+// mesh of the most recent record, which is the mesh to resume with
+string SweepJournal::get_meshLocation ()
+{
+   if (meshLocationList.size() == 0) return "";
+   return meshLocationList.back();
+}
+
+// most recent result location for the frequency
+string SweepJournal::get_resultLocation (double frequency)
+{
+   long unsigned int i=frequencyList.size();
+   while (i > 0) {
+      i--;
+      if (abs(frequencyList[i]-frequency) <= 1e-12*frequency) return resultLocationList[i];
+   }
+   return "";
+}
+
+void SweepJournal::close ()
+{
+   if (fd >= 0) {
+      fsync(fd);
+      ::close(fd);
+      if (activeJournalFd == fd) activeJournalFd=-1;
+      fd=-1;
+   }
+}
+
+SweepJournal::~SweepJournal ()
+{
+   close();
+}
+
@@ -0,0 +1,76 @@
+////////////////////////////////////////////////////////////////////////////////
+//                                                                            //
+//    OpenParEM2D - A fullwave 2D electromagnetic simulator.                  //
+//    Copyright (C) 2025 Brian Young                                          //
+//                                                                            //
+//    This program is free software: you can redistribute it and/or modify    //
+//    it under the terms of the GNU General Public License as published by    //
+//    the Free Software Foundation, either version 3 of the License, or       //
+//    (at your option) any later version.                                     //
+//                                                                            //
+//    This program is distributed in the hope that it will be useful,         //
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of          //
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the           //
+//    GNU General Public License for more details.                            //
+//                                                                            //
+//    You should have received a copy of the GNU General Public License       //
+//    along with this program.  If not, see <http://www.gnu.org/licenses/>.   //
+//                                                                            //
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef SWEEPJOURNAL_H
+#define SWEEPJOURNAL_H
+
+#include "petscsys.h"
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <csignal>
+#include <filesystem>
+#include <fcntl.h>
+#include <unistd.h>
+#include "frequencyPlan.hpp"
+#include "misc.hpp"
+#include "prefix.h"
+
+using namespace std;
+
+extern "C" void prefix ();
+
+// Append-only record of the completed frequencies of a sweep so that a preempted job can resume.
+// Each record is synced to disk before record returns. Rank 0 owns the file.
+//
+// record format, one per line with tab-separated fields:
+//    point  frequency  refined  meshSize  meshHash  meshLocation  resultLocation
+
+class SweepJournal {
+   private:
+      string filename;
+      int fd=-1;                               // rank 0 only
+      string version_name="#OpenParEMjournal";
+      string version_value="1.1";      // 1.1 added meshHash
+      vector<double> frequencyList;            // records from a previous run
+      vector<bool> refinedList;
+      vector<int> meshSizeList;
+      vector<unsigned long long> meshHashList;
+      vector<string> meshLocationList;
+      vector<string> resultLocationList;
+      bool read ();
+   public:
+      ~SweepJournal ();
+      bool open (const char *, bool);
+      bool restore (FrequencyPlan *);
+      bool record (FrequencyPlanPoint *, bool, string, string);
+      long unsigned int get_recordCount () {return frequencyList.size();}
+      string get_meshLocation ();
+      string get_resultLocation (double);
+      void close ();
+};
+
+void journal_flush ();
+bool journal_preempted ();
+
+#endif
+
@@ -0,0 +1,345 @@
+////////////////////////////////////////////////////////////////////////////////
+//                                                                            //
+//    OpenParEM2D - A fullwave 2D electromagnetic simulator.                  //
+//    Copyright (C) 2025 Brian Young                                          //
+//                                                                            //
+//    This program is free software: you can redistribute it and/or modify    //
+//    it under the terms of the GNU General Public License as published by    //
+//    the Free Software Foundation, either version 3 of the License, or       //
+//    (at your option) any later version.                                     //
+//                                                                            //
+//    This program is distributed in the hope that it will be useful,         //
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of          //
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the           //
+//    GNU General Public License for more details.                            //
+//                                                                            //
+//    You should have received a copy of the GNU General Public License       //
+//    along with this program.  If not, see <http://www.gnu.org/licenses/>.   //
+//                                                                            //
+////////////////////////////////////////////////////////////////////////////////
+
+#include "vectorFit.hpp"
+
+// complex pairs spread over the band with light damping, plus a real pole if the count is odd
+void VectorFit::initialPoles (double low, double high)
+{
+   poles.clear();
+   int pairCount=poleCount/2;
+   int i=0;
+   while (i < pairCount) {
+      double beta=low;
+      if (pairCount > 1) beta=low+(high-low)*i/(pairCount-1);
+      poles.push_back(complex<double>(-beta/100,beta));
+      poles.push_back(complex<double>(-beta/100,-beta));
+      i++;
+   }
+   if (poleCount%2 == 1) poles.push_back(complex<double>(-0.5*(low+high),0));
+}
+
+// real-valued basis over the current poles, with columns for a conjugate pair of
+//    1/(s-a)+1/(s-a*) and j/(s-a)-j/(s-a*)
+void VectorFit::basis (vector<complex<double>> *s, Eigen::MatrixXd *Phi_re, Eigen::MatrixXd *Phi_im)
+{
+   long unsigned int K=s->size();
+   Phi_re->resize(K,poleCount);
+   Phi_im->resize(K,poleCount);
+
+   long unsigned int k=0;
+   while (k < K) {
+      int n=0;
+      while (n < poleCount) {
+         if (poles[n].imag() == 0) {
+            complex<double> value=1.0/((*s)[k]-poles[n]);
+            (*Phi_re)(k,n)=value.real();
+            (*Phi_im)(k,n)=value.imag();
+            n++;
+         } else {
+            complex<double> value1=1.0/((*s)[k]-poles[n])+1.0/((*s)[k]-conj(poles[n]));
+            complex<double> value2=complex<double>(0,1)/((*s)[k]-poles[n])-complex<double>(0,1)/((*s)[k]-conj(poles[n]));
+            (*Phi_re)(k,n)=value1.real();
+            (*Phi_im)(k,n)=value1.imag();
+            (*Phi_re)(k,n+1)=value2.real();
+            (*Phi_im)(k,n+1)=value2.imag();
+            n+=2;
+         }
+      }
+      k++;
+   }
+}
+
+// flip unstable poles and order conjugate pairs with the positive imaginary part first
+void VectorFit::sortPoles (Eigen::VectorXcd *eigenvalues)
+{
+   poles.clear();
+   vector<complex<double>> realList;
+   long int i=0;
+   while (i < eigenvalues->size()) {
+      complex<double> pole=(*eigenvalues)(i);
+      if (pole.real() > 0) pole=complex<double>(-pole.real(),pole.imag());
+      if (pole.imag() > 0) {
+         poles.push_back(pole);
+         poles.push_back(conj(pole));
+      } else if (pole.imag() == 0) {
+         realList.push_back(pole);
+      }
+      i++;
+   }
+   i=0;
+   while (i < (long int)realList.size()) {
+      poles.push_back(realList[i]);
+      i++;
+   }
+}
+
+// frequencies in Hz with responses[k] holding the flattened network matrix at frequencies[k]
+bool VectorFit::fit (vector<double> *frequencies, vector<vector<complex<double>>> *responses, int poleCount_, int iterations)
+{
+   fitted=false;
+   poleCount=poleCount_;
+   long unsigned int K=frequencies->size();
+
+   if (poleCount < 1 || K < (long unsigned int)poleCount+1) {
+      prefix(); PetscPrintf(PETSC_COMM_WORLD,"ERROR1131: Rational fit with %d poles requires at least %d frequencies but has %ld.\n",poleCount,poleCount+1,K);
+      return true;
+   }
+
+   responseSize=0;
+   if (responses->size() == K) responseSize=(*responses)[0].size();
+   bool consistent=responseSize > 0;
+   long unsigned int k=0;
+   while (consistent && k < K) {
+      if ((*responses)[k].size() != responseSize) consistent=false;
+      k++;
+   }
+   if (!consistent) {
+      prefix(); PetscPrintf(PETSC_COMM_WORLD,"ERROR1132: Rational fit requires a response of the same size at each frequency.\n");
+      return true;
+   }
+
+   long unsigned int M=responseSize;
+   int N=poleCount;
+
+   frequencyScale=0;
+   double lowFrequency=DBL_MAX;
+   k=0;
+   while (k < K) {
+      if ((*frequencies)[k] > frequencyScale) frequencyScale=(*frequencies)[k];
+      if ((*frequencies)[k] < lowFrequency) lowFrequency=(*frequencies)[k];
+      k++;
+   }
+
+   vector<complex<double>> s(K);
+   k=0;
+   while (k < K) {
+      s[k]=complex<double>(0,(*frequencies)[k]/frequencyScale);
+      k++;
+   }
+
+   double low=lowFrequency/frequencyScale;
+   if (low < 0.01) low=0.01;
+   initialPoles(low,1);
+
+   Eigen::MatrixXd Phi_re,Phi_im;
+
+   // pole relocation with the fast formulation: each response contributes only the rows of its
+   // QR factorization that involve the shared weighting function
+   int iteration=0;
+   while (iteration < iterations) {
+      basis(&s,&Phi_re,&Phi_im);
+
+      Eigen::MatrixXd sigmaSystem(M*N,N);
+      Eigen::VectorXd sigmaRHS(M*N);
+
+      long unsigned int m=0;
+      while (m < M) {
+         Eigen::MatrixXd A=Eigen::MatrixXd::Zero(2*K,2*N+2);
+         k=0;
+         while (k < K) {
+            complex<double> H=(*responses)[k][m];
+            int n=0;
+            while (n < N) {
+               A(k,n)=Phi_re(k,n);
+               A(K+k,n)=Phi_im(k,n);
+               complex<double> product=-H*complex<double>(Phi_re(k,n),Phi_im(k,n));
+               A(k,N+1+n)=product.real();
+               A(K+k,N+1+n)=product.imag();
+               n++;
+            }
+            A(k,N)=1;
+            A(k,2*N+1)=H.real();
+            A(K+k,2*N+1)=H.imag();
+            k++;
+         }
+
+         Eigen::HouseholderQR<Eigen::MatrixXd> qr(A);
+         Eigen::MatrixXd R=qr.matrixQR().triangularView<Eigen::Upper>();
+         sigmaSystem.block(m*N,0,N,N)=R.block(N+1,N+1,N,N);
+         sigmaRHS.segment(m*N,N)=R.block(N+1,2*N+1,N,1);
+         m++;
+      }
+
+      Eigen::VectorXd sigmaResidues=sigmaSystem.colPivHouseholderQr().solve(sigmaRHS);
+
+      // the zeros of the weighting function are the new poles
+      Eigen::MatrixXd lambda=Eigen::MatrixXd::Zero(N,N);
+      Eigen::VectorXd b=Eigen::VectorXd::Zero(N);
+      int n=0;
+      while (n < N) {
+         if (poles[n].imag() == 0) {
+            lambda(n,n)=poles[n].real();
+            b(n)=1;
+            n++;
+         } else {
+            lambda(n,n)=poles[n].real();
+            lambda(n,n+1)=poles[n].imag();
+            lambda(n+1,n)=-poles[n].imag();
+            lambda(n+1,n+1)=poles[n].real();
+            b(n)=2;
+            n+=2;
+         }
+      }
+
+      Eigen::EigenSolver<Eigen::MatrixXd> eigenSolver(lambda-b*sigmaResidues.transpose(),false);
+      Eigen::VectorXcd eigenvalues=eigenSolver.eigenvalues();
+      sortPoles(&eigenvalues);
+
+      iteration++;
+   }
+
+   // residues and constant terms for the final poles
+   basis(&s,&Phi_re,&Phi_im);
+
+   Eigen::MatrixXd A=Eigen::MatrixXd::Zero(2*K,N+1);
+   Eigen::MatrixXd B(2*K,M);
+   k=0;
+   while (k < K) {
+      int n=0;
+      while (n < N) {
+         A(k,n)=Phi_re(k,n);
+         A(K+k,n)=Phi_im(k,n);
+         n++;
+      }
+      A(k,N)=1;
+      long unsigned int m=0;
+      while (m < M) {
+         B(k,m)=(*responses)[k][m].real();
+         B(K+k,m)=(*responses)[k][m].imag();
+         m++;
+      }
+      k++;
+   }
+
+   Eigen::MatrixXd X=A.colPivHouseholderQr().solve(B);
+
+   residues.assign(M,vector<complex<double>>(N));
+   constant.assign(M,0);
+   long unsigned int m=0;
+   while (m < M) {
+      int n=0;
+      while (n < N) {
+         if (poles[n].imag() == 0) {
+            residues[m][n]=X(n,m);
+            n++;
+         } else {
+            residues[m][n]=complex<double>(X(n,m),X(n+1,m));
+            residues[m][n+1]=complex<double>(X(n,m),-X(n+1,m));
+            n+=2;
+         }
+      }
+      constant[m]=X(N,m);
+      m++;
+   }
+
+   fitted=true;
+   fitFrequencyCount=K;
+
+   // fit residuals
+   double scale=0;
+   double sumSquare=0;
+   maxError=0;
+   maxErrorFrequency=0;
+   vector<complex<double>> model;
+   k=0;
+   while (k < K) {
+      evaluate((*frequencies)[k],&model);
+      long unsigned int m=0;
+      while (m < M) {
+         double error=abs(model[m]-(*responses)[k][m]);
+         sumSquare+=error*error;
+         if (error > maxError) {
+            maxError=error;
+            maxErrorFrequency=(*frequencies)[k];
+         }
+         if (abs((*responses)[k][m]) > scale) scale=abs((*responses)[k][m]);
+         m++;
+      }
+      k++;
+   }
+   rmsError=sqrt(sumSquare/(K*M));
+   if (scale > 0) {
+      rmsError/=scale;
+      maxError/=scale;
+   }
+
+   return false;
+}
+
+// fit the responses attached to plan points, such as from FrequencyPlan::get_responses
+bool VectorFit::fit (vector<FrequencyPlanPoint *> *responseList, int poleCount_, int iterations)
+{
+   vector<double> frequencies;
+   vector<vector<complex<double>>> responses;
+   long unsigned int i=0;
+   while (i < responseList->size()) {
+      frequencies.push_back((*responseList)[i]->get_frequency());
+      responses.push_back(*((*responseList)[i]->get_response()));
+      i++;
+   }
+   return fit(&frequencies,&responses,poleCount_,iterations);
+}
+
+void VectorFit::evaluate (double frequency, vector<complex<double>> *result)
+{
+   result->assign(responseSize,0);
+   if (!fitted) return;
+
+   complex<double> s=complex<double>(0,frequency/frequencyScale);
+
+   vector<complex<double>> pole_term(poleCount);
+   int n=0;
+   while (n < poleCount) {
+      pole_term[n]=1.0/(s-poles[n]);
+      n++;
+   }
+
+   long unsigned int m=0;
+   while (m < responseSize) {
+      complex<double> value=constant[m];
+      n=0;
+      while (n < poleCount) {
+         value+=residues[m][n]*pole_term[n];
+         n++;
+      }
+      (*result)[m]=value;
+      m++;
+   }
+}
+
+void VectorFit::evaluate (vector<double> *frequencies, vector<vector<complex<double>>> *results)
+{
+   results->resize(frequencies->size());
+   long unsigned int k=0;
+   while (k < frequencies->size()) {
+      evaluate((*frequencies)[k],&((*results)[k]));
+      k++;
+   }
+}
+
+void VectorFit::print_report (string indent)
+{
+   if (!fitted) return;
+   prefix(); PetscPrintf(PETSC_COMM_WORLD,"%sRational fit: %d poles, %ld frequencies, %ld responses\n",indent.c_str(),poleCount,fitFrequencyCount,responseSize);
+   prefix(); PetscPrintf(PETSC_COMM_WORLD,"%s   relative rms error: %g\n",indent.c_str(),rmsError);
+   prefix(); PetscPrintf(PETSC_COMM_WORLD,"%s   relative max error: %g at %g Hz\n",indent.c_str(),maxError,maxErrorFrequency);
+}
+
@@ -0,0 +1,75 @@
+////////////////////////////////////////////////////////////////////////////////
+//                                                                            //
+//    OpenParEM2D - A fullwave 2D electromagnetic simulator.                  //
+//    Copyright (C) 2025 Brian Young                                          //
+//                                                                            //
+//    This program is free software: you can redistribute it and/or modify    //
+//    it under the terms of the GNU General Public License as published by    //
+//    the Free Software Foundation, either version 3 of the License, or       //
+//    (at your option) any later version.                                     //
+//                                                                            //
+//    This program is distributed in the hope that it will be useful,         //
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of          //
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the           //
+//    GNU General Public License for more details.                            //
+//                                                                            //
+//    You should have received a copy of the GNU General Public License       //
+//    along with this program.  If not, see <http://www.gnu.org/licenses/>.   //
+//                                                                            //
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef VECTORFIT_H
+#define VECTORFIT_H
+
+#include "petscsys.h"
+#include <iostream>
+#include <string>
+#include <vector>
+#include <complex>
+#include <cfloat>
+#include <Eigen/Dense>
+#include "frequencyPlan.hpp"
+#include "prefix.h"
+
+using namespace std;
+
+extern "C" void prefix ();
+
+// Common-pole rational model of a set of frequency responses, such as the flattened Z or S
+// matrices at the solved points of a frequency plan, fitted by vector fitting:
+//
+//    H_m(s) = d_m + sum_n r_mn/(s-a_n)
+//
+// All responses share the poles a_n. Complex poles come in conjugate pairs so that the model
+// describes a real system. Frequencies are normalized to the highest fitted frequency for conditioning.
+
+class VectorFit {
+   private:
+      int poleCount=0;
+      long unsigned int responseSize=0;
+      double frequencyScale=1;                     // Hz
+      vector<complex<double>> poles;               // normalized, conjugate pairs adjacent with positive imaginary part first
+      vector<vector<complex<double>>> residues;    // [response][pole], normalized
+      vector<complex<double>> constant;            // [response]
+      double rmsError=DBL_MAX;                     // relative to the largest response magnitude
+      double maxError=DBL_MAX;
+      double maxErrorFrequency=0;
+      long unsigned int fitFrequencyCount=0;
+      bool fitted=false;
+      void initialPoles (double, double);
+      void basis (vector<complex<double>> *, Eigen::MatrixXd *, Eigen::MatrixXd *);
+      void sortPoles (Eigen::VectorXcd *);
+   public:
+      bool fit (vector<double> *, vector<vector<complex<double>>> *, int, int);
+      bool fit (vector<FrequencyPlanPoint *> *, int, int);
+      void evaluate (double, vector<complex<double>> *);
+      void evaluate (vector<double> *, vector<vector<complex<double>>> *);
+      bool is_fitted () {return fitted;}
+      int get_poleCount () {return poleCount;}
+      double get_rmsError () {return rmsError;}
+      double get_maxError () {return maxError;}
+      void print_report (string);
+};
+
+#endif
+